@@ -3,14 +3,19 @@
 
 #include "child_node_iterator.hpp"
 #include "heuristic_function.hpp"
+#include "search_budget_exceeded_exception.hpp"
 #include "path_not_found_exception.hpp"
+#include "search_trace.hpp"
 #include "weighted_path.hpp"
 #include "weight_function.hpp"
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace net {
 namespace coderodde {
@@ -40,7 +45,7 @@ namespace pathfinding {
     weighted_path<Node, Weight>
     traceback_path(Node& target,
                    std::unordered_map<Node*, Node*>& parents,
-                   weight_function<Node, Weight>& w) {
+                   const weight_function<Node, Weight>& w) {
         std::vector<Node*> path;
         Node* current_node = &target;
         
@@ -60,12 +65,43 @@ namespace pathfinding {
         return weighted_path<Node, Weight>(path, total_weight);
     }
     
+    // Approximate bytes of search state per reached node: its entries in the
+    // distance, estimate, parent and closed hash tables, each with a next
+    // pointer, a cached hash and a bucket slot.
     template<typename Node, typename Weight>
-    weighted_path<Node, Weight> search(Node& source,
-                                       Node& target,
-                                       
-                                       weight_function<Node, Weight>& w,
-                                       heuristic_function<Node, Weight>& h) {
+    std::size_t reached_node_bytes() {
+        const std::size_t entry_overhead = 3 * sizeof(void*);
+        return 2 * (sizeof(std::pair<Node* const, Weight>) + entry_overhead)
+             + sizeof(std::pair<Node* const, Node*>) + entry_overhead
+             + sizeof(Node*) + entry_overhead;
+    }
+    
+    // Approximate bytes of one open list entry: the heap slot and the
+    // allocated holder with its allocator header.
+    template<typename Node, typename Weight>
+    std::size_t open_entry_bytes() {
+        return sizeof(node_holder<Node, Weight>*)
+             + sizeof(node_holder<Node, Weight>) + 2 * sizeof(void*);
+    }
+    
+    // Runs A* from 'source' until a node satisfying 'is_goal' is removed from
+    // the open list and returns that node, or returns nullptr if no such node
+    // is reachable. On success 'parents' maps each node on the path to its
+    // predecessor. If 'tracer' is given, the expansions and relaxations are
+    // recorded to it. A nonzero 'memory_budget' aborts the search with a
+    // 'search_budget_exceeded_exception' as soon as its state is estimated to
+    // take more than that many bytes.
+    template<typename Node, typename Weight, typename GoalPredicate>
+    Node* search_until(Node& source,
+                       GoalPredicate is_goal,
+                       const weight_function<Node, Weight>& w,
+                       const heuristic_function<Node, Weight>& h,
+                       std::unordered_map<Node*, Node*>& parents,
+                       trace_recorder* tracer = nullptr,
+                       std::size_t memory_budget = 0) {
+        trace_key<Node> key;
+        query_trace trace = tracer ? tracer->begin_query(key(source))
+                                   : query_trace{};
 
         auto cmp = [](node_holder<Node, Weight>* nh1,
                       node_holder<Node, Weight>* nh2) {
@@ -77,20 +113,35 @@ namespace pathfinding {
                             decltype(cmp)> open(cmp);
         
         std::unordered_set<Node*> closed;
-        std::unordered_map<Node*, Node*> parents;
         std::unordered_map<Node*, Weight> distances;
         
+        // Heuristic estimates are computed once per node, in one batch per
+        // expansion:
+        std::unordered_map<Node*, Weight> estimates;
+        std::vector<Node*> improved_nodes;
+        std::vector<Weight*> improved_estimates;
+        std::vector<Node*> unestimated_nodes;
+        std::vector<Weight*> unestimated_estimates;
+        std::vector<Weight> new_estimates;
+        
         open.push(new node_holder<Node, Weight>(&source, Weight{}));
         parents[&source] = nullptr;
         distances[&source] = Weight{};
         
         while (!open.empty()) {
-            Node& current_node = *open.top()->m_node;
+            node_holder<Node, Weight>* current_node_holder = open.top();
+            Node& current_node = *current_node_holder->m_node;
             open.pop();
+            delete current_node_holder;
             
-            if (current_node == target) {
+            if (is_goal(current_node)) {
                 remove_and_delete_all_node_holders(open);
-                return traceback_path(current_node, parents, w);
+                
+                if (trace.active()) {
+                    trace.end(key(current_node), true);
+                }
+                
+                return &current_node;
             }
             
             if (closed.find(&current_node) != closed.end()) {
@@ -99,7 +150,19 @@ namespace pathfinding {
             
             closed.insert(&current_node);
             
-            for (Node& child_node : current_node) {
+            if (trace.active()) {
+                trace.expansion(key(current_node), open.size());
+            }
+            improved_nodes.clear();
+            improved_estimates.clear();
+            unestimated_nodes.clear();
+            unestimated_estimates.clear();
+            
+            // Only the const 'begin()' and 'end()' of a node are used, so
+            // concurrent searches may share the graph.
+            const Node& expanded_node = current_node;
+            
+            for (Node& child_node : expanded_node) {
                 if (closed.find(&child_node) != closed.end()) {
                     continue;
                 }
@@ -109,17 +172,91 @@ namespace pathfinding {
                 
                 if (distances.find(&child_node) == distances.end()
                     || distances[&child_node] > tentative_distance) {
-                    open.push(new node_holder<Node, Weight>(
-                                        &child_node,
-                                        tentative_distance + h(child_node)));
                     distances[&child_node] = tentative_distance;
                     parents[&child_node] = &current_node;
+                    improved_nodes.push_back(&child_node);
+                    
+                    if (trace.active()) {
+                        trace.relaxation(key(child_node));
+                    }
+                    
+                    // Map entries do not move on rehashing, so the estimate
+                    // is filled in through its address below.
+                    auto estimate = estimates.emplace(&child_node, Weight{});
+                    improved_estimates.push_back(&estimate.first->second);
+                    
+                    if (estimate.second) {
+                        unestimated_nodes.push_back(&child_node);
+                        unestimated_estimates.push_back(
+                                                &estimate.first->second);
+                    }
+                }
+            }
+            
+            if (!unestimated_nodes.empty()) {
+                new_estimates.resize(unestimated_nodes.size());
+                h.estimate_batch(unestimated_nodes.data(),
+                                 unestimated_nodes.size(),
+                                 new_estimates.data());
+                
+                for (size_t i = 0; i < unestimated_nodes.size(); ++i) {
+                    *unestimated_estimates[i] = new_estimates[i];
                 }
             }
+            
+            for (size_t i = 0; i < improved_nodes.size(); ++i) {
+                open.push(new node_holder<Node, Weight>(
+                                    improved_nodes[i],
+                                    distances[improved_nodes[i]] +
+                                    *improved_estimates[i]));
+            }
+            
+            if (memory_budget > 0
+                && distances.size() * reached_node_bytes<Node, Weight>()
+                   + open.size() * open_entry_bytes<Node, Weight>()
+                   > memory_budget) {
+                remove_and_delete_all_node_holders(open);
+                
+                if (trace.active()) {
+                    trace.end(0, false);
+                }
+                
+                throw search_budget_exceeded_exception::memory(memory_budget);
+            }
+        }
+        
+        if (trace.active()) {
+            trace.end(0, false);
+        }
+        
+        return nullptr;
+    }
+    
+    template<typename Node, typename Weight>
+    weighted_path<Node, Weight> search(Node& source,
+                                       Node& target,
+                                       
+                                       const weight_function<Node, Weight>& w,
+                                       const heuristic_function<Node, Weight>& h,
+                                       trace_recorder* tracer = nullptr,
+                                       std::size_t memory_budget = 0) {
+        std::unordered_map<Node*, Node*> parents;
+        
+        Node* reached = search_until(source,
+                                     [&target](Node& node) {
+                                         return node == target;
+                                     },
+                                     w,
+                                     h,
+                                     parents,
+                                     tracer,
+                                     memory_budget);
+        
+        if (!reached) {
+            throw path_not_found_exception<Node>(source, target);
         }
         
-        remove_and_delete_all_node_holders(open);
-        throw path_not_found_exception<Node>(source, target);
+        return traceback_path(*reached, parents, w);
     }
 } // End of namespace net::coderodde::pathfinding.
 } // End of namespace net::coderodde.
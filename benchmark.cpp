@@ -0,0 +1,371 @@
+// Measures the effect of node order on 'contiguous_graph' searches.
+//
+// Usage: benchmark [grid side] [query count]
+//        benchmark --movingai <.map file> <.scen file>
+//
+// Builds a 4-connected grid with 20% blocked cells whose nodes are created
+// and numbered in random order, then runs the same Dijkstra and A* queries
+// on the original numbering and after BFS, reverse Cuthill-McKee and Hilbert
+// reordering. Prints the time and, where the kernel allows it, the hardware
+// cache misses per query.
+//
+// With '--movingai', loads a MovingAI benchmark instance instead and runs
+// its scenarios with A*, checking the path lengths against the optimal
+// lengths the scenario file lists.
+
+#include "contiguous_search.hpp"
+#include "graph_loaders.hpp"
+#include "graph_reordering.hpp"
+#include "metric_heuristics.hpp"
+#include "path_not_found_exception.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using net::coderodde::pathfinding::bfs_order;
+using net::coderodde::pathfinding::contiguous_graph;
+using net::coderodde::pathfinding::cuthill_mckee_order;
+using net::coderodde::pathfinding::hilbert_order;
+using net::coderodde::pathfinding::indexed_graph;
+using net::coderodde::pathfinding::indexed_node;
+using net::coderodde::pathfinding::load_movingai_map;
+using net::coderodde::pathfinding::load_movingai_scenarios;
+using net::coderodde::pathfinding::manhattan_heuristic;
+using net::coderodde::pathfinding::movingai_scenario;
+using net::coderodde::pathfinding::octile_heuristic;
+using net::coderodde::pathfinding::path_not_found_exception;
+using net::coderodde::pathfinding::weight_function;
+
+class bench_node {
+public:
+    bench_node(int x, int y) : m_x{x}, m_y{y} {}
+
+    int x() const { return m_x; }
+    int y() const { return m_y; }
+
+    void add_child(bench_node& child) {
+        m_children.push_back(&child);
+    }
+
+    bool operator==(const bench_node& other) const {
+        return m_x == other.m_x && m_y == other.m_y;
+    }
+
+    class child_iterator {
+    public:
+        child_iterator(std::vector<bench_node*>::const_iterator it) : m_it{it} {}
+
+        child_iterator& operator++() {
+            ++m_it;
+            return *this;
+        }
+
+        bool operator!=(const child_iterator& other) const {
+            return m_it != other.m_it;
+        }
+
+        bench_node& operator*() {
+            return **m_it;
+        }
+
+    private:
+        std::vector<bench_node*>::const_iterator m_it;
+    };
+
+    child_iterator begin() const { return child_iterator(m_children.begin()); }
+    child_iterator end()   const { return child_iterator(m_children.end()); }
+
+private:
+    int m_x;
+    int m_y;
+    std::vector<bench_node*> m_children;
+};
+
+std::ostream& operator<<(std::ostream& out, const bench_node& node) {
+    return out << "{x=" << node.x() << ", y=" << node.y() << "}";
+}
+
+class unit_weight_function : public virtual weight_function<bench_node, int> {
+public:
+    int operator()(const bench_node&, const bench_node&) const {
+        return 1;
+    }
+};
+
+// Counts last-level cache misses of the calling thread. Reports -1 when
+// hardware counters are unavailable (not Linux, or perf_event_paranoid).
+class cache_miss_counter {
+public:
+    cache_miss_counter() : m_fd{-1} {
+#ifdef __linux__
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open,
+                                        &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    ~cache_miss_counter() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+#ifdef __linux__
+        long long count = 0;
+
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(m_fd, &count, sizeof(count)) == sizeof(count)) {
+                return count;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int m_fd;
+};
+
+static void run_queries(
+            const std::string& label,
+            const contiguous_graph<bench_node, int>& graph,
+            const std::vector<std::pair<bench_node*, bench_node*>>& queries,
+            bool use_heuristic) {
+    cache_miss_counter counter;
+    long long total_weight = 0;
+    std::size_t found = 0;
+
+    counter.start();
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (const auto& query : queries) {
+        try {
+            if (use_heuristic) {
+                manhattan_heuristic<bench_node, int> h(*query.second);
+                total_weight += search(graph,
+                                       *query.first,
+                                       *query.second,
+                                       h).total_weight();
+            } else {
+                total_weight += search(graph,
+                                       *query.first,
+                                       *query.second).total_weight();
+            }
+
+            ++found;
+        } catch (path_not_found_exception<bench_node>&) {
+        }
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    long long misses = counter.stop();
+    double seconds = std::chrono::duration<double>(end_time - start_time).count();
+
+    std::cout << std::left << std::setw(26) << label << std::right
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << 1000.0 * seconds / queries.size()
+              << " ms/query";
+
+    if (misses >= 0) {
+        std::cout << std::setw(12) << misses / static_cast<long long>(queries.size())
+                  << " misses/query";
+    } else {
+        std::cout << "      misses n/a";
+    }
+
+    std::cout << "   (found " << found << ", total " << total_weight << ")\n";
+}
+
+static int run_movingai(const std::string& map_file_name,
+                        const std::string& scen_file_name) {
+    auto load_start = std::chrono::steady_clock::now();
+    indexed_graph<double> graph = load_movingai_map<double>(map_file_name);
+    std::vector<movingai_scenario> scenarios =
+    load_movingai_scenarios(scen_file_name);
+    auto load_end = std::chrono::steady_clock::now();
+
+    std::cout << map_file_name << ": " << graph.node_count() << " nodes, "
+              << graph.edge_count() << " edges, " << scenarios.size()
+              << " scenarios, loaded in " << std::fixed << std::setprecision(3)
+              << std::chrono::duration<double>(load_end - load_start).count()
+              << " s\n";
+
+    std::size_t mismatches = 0;
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (const movingai_scenario& scenario : scenarios) {
+        if (scenario.m_width * scenario.m_height != graph.node_count()) {
+            throw std::runtime_error{"Scenario does not match the map."};
+        }
+
+        indexed_node<double>& source =
+        graph.node(scenario.m_start_y * scenario.m_width + scenario.m_start_x);
+        indexed_node<double>& target =
+        graph.node(scenario.m_goal_y * scenario.m_width + scenario.m_goal_x);
+        octile_heuristic<indexed_node<double>, double> h(target);
+        double length = -1.0;
+
+        try {
+            length = search(graph.graph(), source, target, h).total_weight();
+        } catch (path_not_found_exception<indexed_node<double>>&) {
+        }
+
+        // The scenario files round the lengths to a few decimals.
+        if (std::abs(length - scenario.m_optimal_length) > 1e-3) {
+            ++mismatches;
+        }
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end_time - start_time).count();
+
+    std::cout << "A*: " << std::setprecision(3)
+              << 1000.0 * seconds / std::max<std::size_t>(1, scenarios.size())
+              << " ms/query, " << mismatches << " non-optimal\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, const char * argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--movingai") {
+        if (argc != 4) {
+            std::cerr << "Usage: benchmark --movingai <.map file> <.scen file>\n";
+            return 2;
+        }
+
+        return run_movingai(argv[2], argv[3]);
+    }
+
+    int side = argc > 1 ? std::atoi(argv[1]) : 1000;
+    std::size_t query_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+
+    std::mt19937 random(13);
+    std::vector<std::pair<int, int>> cells;
+
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            cells.emplace_back(x, y);
+        }
+    }
+
+    // Create the nodes in random order so that neither their addresses nor
+    // their initial ids follow the grid.
+    std::shuffle(cells.begin(), cells.end(), random);
+
+    std::vector<bench_node> nodes;
+    std::vector<int> index_of(side * side);
+    std::vector<char> blocked(side * side);
+    std::bernoulli_distribution block(0.2);
+
+    nodes.reserve(cells.size());
+
+    for (const auto& cell : cells) {
+        index_of[cell.second * side + cell.first] = static_cast<int>(nodes.size());
+        blocked[cell.second * side + cell.first] = block(random);
+        nodes.emplace_back(cell.first, cell.second);
+    }
+
+    const int dx[] = { 0, 0, -1, 1 };
+    const int dy[] = { -1, 1, 0, 0 };
+
+    for (bench_node& node : nodes) {
+        if (blocked[node.y() * side + node.x()]) {
+            continue;
+        }
+
+        for (int d = 0; d < 4; ++d) {
+            int x = node.x() + dx[d];
+            int y = node.y() + dy[d];
+
+            if (x >= 0 && y >= 0 && x < side && y < side
+                && !blocked[y * side + x]) {
+                node.add_child(nodes[index_of[y * side + x]]);
+            }
+        }
+    }
+
+    std::vector<bench_node*> node_pointers;
+
+    for (bench_node& node : nodes) {
+        node_pointers.push_back(&node);
+    }
+
+    std::vector<std::pair<bench_node*, bench_node*>> queries;
+    std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+
+    while (queries.size() < query_count) {
+        bench_node* source = &nodes[pick(random)];
+        bench_node* target = &nodes[pick(random)];
+
+        if (!blocked[source->y() * side + source->x()]
+            && !blocked[target->y() * side + target->x()]) {
+            queries.emplace_back(source, target);
+        }
+    }
+
+    unit_weight_function w;
+    contiguous_graph<bench_node, int> original(node_pointers, w);
+
+    std::cout << side << " x " << side << " grid, "
+              << original.node_count() << " nodes, "
+              << original.edge_count() << " edges, "
+              << queries.size() << " queries\n";
+
+    const char* algorithms[] = { "Dijkstra", "A*" };
+
+    for (int a = 0; a < 2; ++a) {
+        bool use_heuristic = a == 1;
+        std::cout << algorithms[a] << ":\n";
+
+        run_queries("  random order", original, queries, use_heuristic);
+
+        contiguous_graph<bench_node, int> bfs = original;
+        bfs.reorder(bfs_order(bfs));
+        run_queries("  BFS order", bfs, queries, use_heuristic);
+
+        contiguous_graph<bench_node, int> rcm = original;
+        rcm.reorder(cuthill_mckee_order(rcm));
+        run_queries("  reverse Cuthill-McKee", rcm, queries, use_heuristic);
+
+        contiguous_graph<bench_node, int> hilbert = original;
+        hilbert.reorder(hilbert_order(hilbert));
+        run_queries("  Hilbert order", hilbert, queries, use_heuristic);
+    }
+}
@@ -0,0 +1,305 @@
+#ifndef NET_CODERODDE_PATHFINDING_CONTIGUOUS_GRAPH_HPP
+#define NET_CODERODDE_PATHFINDING_CONTIGUOUS_GRAPH_HPP
+
+#include "weight_function.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // Translates node ids between two numberings of the same graph.
+    struct node_id_mapping {
+        std::vector<std::uint32_t> m_old_to_new;
+        std::vector<std::uint32_t> m_new_to_old;
+
+        std::uint32_t to_new(std::uint32_t old_id) const {
+            return m_old_to_new.at(old_id);
+        }
+
+        std::uint32_t to_old(std::uint32_t new_id) const {
+            return m_new_to_old.at(new_id);
+        }
+    };
+
+    // Node types that know their position in the node list of a
+    // 'contiguous_graph' specialize this with 'stores_id' set to true and a
+    // static 'id(node)'; the graph then looks ids up in the nodes instead of
+    // building an address-to-id table. Nodes whose stored id differs from
+    // their position, for example after 'reorder()', fall back to the table.
+    template<typename Node>
+    struct node_id_traits {
+        static const bool stores_id = false;
+
+        static std::uint32_t id(const Node&) {
+            return 0;
+        }
+    };
+
+    // A snapshot of a graph in compressed sparse row form: the nodes are
+    // numbered 0, 1, ..., node_count() - 1, and the heads and weights of the
+    // edges leaving node 'id' are stored contiguously in
+    // [heads(id), heads(id) + degree(id)) and [weights(id), ...). The search
+    // over this layout touches no hash tables and lets 'relax_edges()'
+    // process several edges per instruction.
+    //
+    // The snapshot does not track later changes to the original nodes.
+    template<typename Node, typename Weight>
+    class contiguous_graph {
+    public:
+
+        // Numbers 'nodes' in the given order and copies their outgoing edges
+        // and edge weights. Every child of every node must be in 'nodes'.
+        contiguous_graph(const std::vector<Node*>& nodes,
+                         const weight_function<Node, Weight>& w)
+        :
+        m_nodes{nodes}
+        {
+            check_node_count();
+            assign_ids();
+            m_ids_from_nodes = false;
+
+            m_offsets.reserve(m_nodes.size() + 1);
+            m_offsets.push_back(0);
+
+            for (const Node* node : m_nodes) {
+                for (Node& child_node : *node) {
+                    auto it = m_ids.find(&child_node);
+
+                    if (it == m_ids.end()) {
+                        throw std::invalid_argument{
+                            "A child node is missing from the node list."};
+                    }
+
+                    m_heads.push_back(it->second);
+                    m_weights.push_back(w(*node, child_node));
+                }
+
+                m_offsets.push_back(m_heads.size());
+            }
+
+            compute_max_degree();
+        }
+
+        // Adopts prebuilt arrays: the edges of node 'id' occupy positions
+        // [offsets[id], offsets[id + 1]) of 'heads' and 'weights'.
+        contiguous_graph(const std::vector<Node*>& nodes,
+                         std::vector<std::size_t> offsets,
+                         std::vector<std::uint32_t> heads,
+                         std::vector<Weight> weights)
+        :
+        m_nodes{nodes},
+        m_offsets{std::move(offsets)},
+        m_heads{std::move(heads)},
+        m_weights{std::move(weights)}
+        {
+            check_node_count();
+
+            if (m_offsets.size() != m_nodes.size() + 1
+                || m_heads.size() != m_weights.size()
+                || m_offsets.front() != 0
+                || m_offsets.back() != m_heads.size()
+                || !std::is_sorted(m_offsets.begin(), m_offsets.end())) {
+                throw std::invalid_argument{"Inconsistent adjacency arrays."};
+            }
+
+            for (std::uint32_t head : m_heads) {
+                if (head >= m_nodes.size()) {
+                    throw std::invalid_argument{"Edge head out of range."};
+                }
+            }
+
+            index_nodes();
+            compute_max_degree();
+        }
+
+        std::size_t node_count() const {
+            return m_nodes.size();
+        }
+
+        std::size_t edge_count() const {
+            return m_heads.size();
+        }
+
+        std::size_t max_degree() const {
+            return m_max_degree;
+        }
+
+        std::uint32_t id_of(Node& node) const {
+            if (m_ids_from_nodes) {
+                std::uint32_t id = node_id_traits<Node>::id(node);
+
+                if (id >= m_nodes.size() || m_nodes[id] != &node) {
+                    throw std::out_of_range{"The node is not in the graph."};
+                }
+
+                return id;
+            }
+
+            auto it = m_ids.find(&node);
+
+            if (it == m_ids.end()) {
+                throw std::out_of_range{"The node is not in the graph."};
+            }
+
+            return it->second;
+        }
+
+        Node& node_at(std::uint32_t id) const {
+            return *m_nodes.at(id);
+        }
+
+        std::size_t degree(std::uint32_t id) const {
+            return m_offsets[id + 1] - m_offsets[id];
+        }
+
+        const std::uint32_t* heads(std::uint32_t id) const {
+            return m_heads.data() + m_offsets[id];
+        }
+
+        const Weight* weights(std::uint32_t id) const {
+            return m_weights.data() + m_offsets[id];
+        }
+
+        // Renumbers the nodes so that the node with id 'new_to_old[i]' gets
+        // id i, and moves its edges and weights to the matching position of
+        // the adjacency arrays. The edges of each node are sorted by head.
+        // Node references and 'weighted_path's are unaffected; callers that
+        // store ids translate them with the returned mapping.
+        node_id_mapping reorder(const std::vector<std::uint32_t>& new_to_old) {
+            node_id_mapping mapping;
+            mapping.m_new_to_old = new_to_old;
+            mapping.m_old_to_new.assign(m_nodes.size(),
+                                        std::numeric_limits<std::uint32_t>::max());
+
+            if (new_to_old.size() != m_nodes.size()) {
+                throw std::invalid_argument{"Not a permutation of the nodes."};
+            }
+
+            for (std::size_t new_id = 0; new_id < new_to_old.size(); ++new_id) {
+                std::uint32_t old_id = new_to_old[new_id];
+
+                if (old_id >= m_nodes.size()
+                    || mapping.m_old_to_new[old_id] !=
+                       std::numeric_limits<std::uint32_t>::max()) {
+                    throw std::invalid_argument{
+                        "Not a permutation of the nodes."};
+                }
+
+                mapping.m_old_to_new[old_id] = static_cast<std::uint32_t>(new_id);
+            }
+
+            std::vector<Node*> nodes(m_nodes.size());
+            std::vector<std::size_t> offsets;
+            std::vector<std::uint32_t> heads;
+            std::vector<Weight> weights;
+            std::vector<std::pair<std::uint32_t, Weight>> edges;
+
+            offsets.reserve(m_offsets.size());
+            offsets.push_back(0);
+            heads.reserve(m_heads.size());
+            weights.reserve(m_weights.size());
+
+            for (std::size_t new_id = 0; new_id < new_to_old.size(); ++new_id) {
+                std::uint32_t old_id = new_to_old[new_id];
+                nodes[new_id] = m_nodes[old_id];
+                edges.clear();
+
+                for (std::size_t i = m_offsets[old_id];
+                     i < m_offsets[old_id + 1];
+                     ++i) {
+                    edges.emplace_back(mapping.m_old_to_new[m_heads[i]],
+                                       m_weights[i]);
+                }
+
+                std::sort(edges.begin(),
+                          edges.end(),
+                          [](const std::pair<std::uint32_t, Weight>& a,
+                             const std::pair<std::uint32_t, Weight>& b) {
+                              return a.first < b.first;
+                          });
+
+                for (const auto& edge : edges) {
+                    heads.push_back(edge.first);
+                    weights.push_back(edge.second);
+                }
+
+                offsets.push_back(heads.size());
+            }
+
+            m_nodes   = std::move(nodes);
+            m_offsets = std::move(offsets);
+            m_heads   = std::move(heads);
+            m_weights = std::move(weights);
+            index_nodes();
+            return mapping;
+        }
+
+    private:
+
+        void check_node_count() const {
+            // Node ids are used as signed 32-bit gather indices.
+            if (m_nodes.size() >
+                static_cast<std::size_t>(
+                            std::numeric_limits<std::int32_t>::max())) {
+                throw std::length_error{"Too many nodes."};
+            }
+        }
+
+        void assign_ids() {
+            m_ids.clear();
+            m_ids.reserve(m_nodes.size());
+
+            for (std::size_t id = 0; id < m_nodes.size(); ++id) {
+                m_ids[m_nodes[id]] = static_cast<std::uint32_t>(id);
+            }
+        }
+
+        // Uses the ids stored in the nodes if they all match their
+        // positions, and the address-to-id table otherwise.
+        void index_nodes() {
+            m_ids_from_nodes = node_id_traits<Node>::stores_id;
+
+            for (std::size_t id = 0;
+                 id < m_nodes.size() && m_ids_from_nodes;
+                 ++id) {
+                m_ids_from_nodes = node_id_traits<Node>::id(*m_nodes[id]) == id;
+            }
+
+            if (m_ids_from_nodes) {
+                std::unordered_map<Node*, std::uint32_t>().swap(m_ids);
+            } else {
+                assign_ids();
+            }
+        }
+
+        void compute_max_degree() {
+            m_max_degree = 0;
+
+            for (std::size_t id = 0; id < m_nodes.size(); ++id) {
+                m_max_degree = std::max(m_max_degree,
+                                        m_offsets[id + 1] - m_offsets[id]);
+            }
+        }
+
+        std::vector<Node*>                       m_nodes;
+        std::unordered_map<Node*, std::uint32_t> m_ids;
+        std::vector<std::size_t>                 m_offsets;
+        std::vector<std::uint32_t>               m_heads;
+        std::vector<Weight>                      m_weights;
+        std::size_t                              m_max_degree;
+        bool                                     m_ids_from_nodes;
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_CONTIGUOUS_GRAPH_HPP
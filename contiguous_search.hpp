@@ -0,0 +1,157 @@
+#ifndef NET_CODERODDE_PATHFINDING_CONTIGUOUS_SEARCH_HPP
+#define NET_CODERODDE_PATHFINDING_CONTIGUOUS_SEARCH_HPP
+
+#include "contiguous_graph.hpp"
+#include "dijkstra.hpp"
+#include "heuristic_function.hpp"
+#include "path_not_found_exception.hpp"
+#include "relaxation_kernel.hpp"
+#include "weighted_path.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    template<typename Weight>
+    struct id_holder {
+        std::uint32_t m_id;
+        Weight        m_f;
+
+        id_holder(std::uint32_t id, Weight f) : m_id{id}, m_f{f} {}
+    };
+
+    // Weight used for nodes not reached yet.
+    template<typename Weight>
+    Weight unreached_distance() {
+        return std::numeric_limits<Weight>::has_infinity ?
+               std::numeric_limits<Weight>::infinity() :
+               std::numeric_limits<Weight>::max();
+    }
+
+    // A* over a 'contiguous_graph'. The search state lives in arrays indexed
+    // by node id, the edges of each expanded node are relaxed in batches by
+    // 'relax_open_edges()', and the improved children are estimated in one
+    // 'estimate_batch()' call.
+    template<typename Node, typename Weight>
+    weighted_path<Node, Weight> search(const contiguous_graph<Node, Weight>& graph,
+                                       Node& source,
+                                       Node& target,
+                                       const heuristic_function<Node, Weight>& h) {
+        static_assert(std::is_arithmetic<Weight>::value,
+                      "contiguous_graph search needs an arithmetic weight.");
+
+        const std::uint32_t no_parent = std::numeric_limits<std::uint32_t>::max();
+        const std::uint32_t source_id = graph.id_of(source);
+        const std::uint32_t target_id = graph.id_of(target);
+
+        std::vector<Weight> distances(graph.node_count(),
+                                      unreached_distance<Weight>());
+        std::vector<std::uint32_t> parents(graph.node_count(), no_parent);
+        std::vector<char> closed(graph.node_count(), 0);
+
+        std::vector<std::uint32_t> improved_ids(graph.max_degree());
+        std::vector<Weight> improved_distances(graph.max_degree());
+
+        // Heuristic estimates, computed once per node and in batches:
+        std::vector<Weight> estimates(graph.node_count());
+        std::vector<char> estimated(graph.node_count(), 0);
+        std::vector<Node*> unestimated_nodes(graph.max_degree());
+        std::vector<std::uint32_t> unestimated_ids(graph.max_degree());
+        std::vector<Weight> new_estimates(graph.max_degree());
+
+        auto cmp = [](const id_holder<Weight>& ih1, const id_holder<Weight>& ih2) {
+            return ih1.m_f > ih2.m_f;
+        };
+
+        std::priority_queue<id_holder<Weight>,
+                            std::vector<id_holder<Weight>>,
+                            decltype(cmp)> open(cmp);
+
+        open.push(id_holder<Weight>(source_id, Weight{}));
+        distances[source_id] = Weight{};
+
+        while (!open.empty()) {
+            std::uint32_t current_id = open.top().m_id;
+            open.pop();
+
+            if (current_id == target_id) {
+                std::vector<Node*> path;
+
+                for (std::uint32_t id = current_id;
+                     id != no_parent;
+                     id = parents[id]) {
+                    path.push_back(&graph.node_at(id));
+                }
+
+                std::reverse(path.begin(), path.end());
+                return weighted_path<Node, Weight>(path, distances[target_id]);
+            }
+
+            if (closed[current_id]) {
+                continue;
+            }
+
+            closed[current_id] = 1;
+
+            std::size_t pushed = relax_open_edges(graph.heads(current_id),
+                                                  graph.weights(current_id),
+                                                  graph.degree(current_id),
+                                                  distances.data(),
+                                                  closed.data(),
+                                                  distances[current_id],
+                                                  improved_ids.data(),
+                                                  improved_distances.data());
+            std::size_t unestimated = 0;
+
+            for (std::size_t i = 0; i < pushed; ++i) {
+                std::uint32_t child_id = improved_ids[i];
+                parents[child_id] = current_id;
+
+                if (!estimated[child_id]) {
+                    estimated[child_id] = 1;
+                    unestimated_ids[unestimated] = child_id;
+                    unestimated_nodes[unestimated] = &graph.node_at(child_id);
+                    ++unestimated;
+                }
+            }
+
+            if (unestimated > 0) {
+                h.estimate_batch(unestimated_nodes.data(),
+                                 unestimated,
+                                 new_estimates.data());
+
+                for (std::size_t i = 0; i < unestimated; ++i) {
+                    estimates[unestimated_ids[i]] = new_estimates[i];
+                }
+            }
+
+            for (std::size_t i = 0; i < pushed; ++i) {
+                std::uint32_t child_id = improved_ids[i];
+                open.push(id_holder<Weight>(child_id,
+                                            distances[child_id] +
+                                            estimates[child_id]));
+            }
+        }
+
+        throw path_not_found_exception<Node>(source, target);
+    }
+
+    template<typename Node, typename Weight>
+    weighted_path<Node, Weight> search(const contiguous_graph<Node, Weight>& graph,
+                                       Node& source,
+                                       Node& target) {
+        zero_heuristic<Node, Weight> h;
+        return search(graph, source, target, h);
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_CONTIGUOUS_SEARCH_HPP
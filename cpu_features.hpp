@@ -0,0 +1,48 @@
+#ifndef NET_CODERODDE_PATHFINDING_CPU_FEATURES_HPP
+#define NET_CODERODDE_PATHFINDING_CPU_FEATURES_HPP
+
+// The vectorized kernels are compiled with per-function target attributes
+// and selected at run time, so the library itself needs no -mavx2 or
+// -mavx512f. Other compilers and architectures get the scalar code only.
+#if (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#define NET_CODERODDE_PATHFINDING_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    enum class simd_level {
+        scalar,
+        avx2,
+        avx512
+    };
+
+    inline simd_level detect_simd_level() {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f")) {
+            return simd_level::avx512;
+        }
+
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_level::avx2;
+        }
+#endif
+        return simd_level::scalar;
+    }
+
+    // The best instruction set available on this machine, detected once.
+    inline simd_level supported_simd_level() {
+        static const simd_level level = detect_simd_level();
+        return level;
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_CPU_FEATURES_HPP
@@ -22,9 +22,11 @@ namespace pathfinding {
     template<typename Node, typename Weight>
     weighted_path<Node, Weight> search(Node& source,
                                        Node& target,
-                                       weight_function<Node, Weight>& w) {
+                                       const weight_function<Node, Weight>& w,
+                                       trace_recorder* tracer = nullptr,
+                                       std::size_t memory_budget = 0) {
         zero_heuristic<Node, Weight> h;
-        return search(source, target, w, h);
+        return search(source, target, w, h, tracer, memory_budget);
     }
     
 } // End of namespace net::coderodde::pathfinding.
@@ -0,0 +1,541 @@
+#ifndef NET_CODERODDE_PATHFINDING_DISTANCE_ORACLE_HPP
+#define NET_CODERODDE_PATHFINDING_DISTANCE_ORACLE_HPP
+
+#include "contiguous_graph.hpp"
+#include "contiguous_search.hpp"
+#include "cpu_features.hpp"
+#include "parallel_for.hpp"
+#include "path_not_found_exception.hpp"
+#include "relaxation_kernel.hpp"
+#include "weight_function.hpp"
+#include "weighted_path.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // One Floyd-Warshall step on a row of the distance matrix: for every
+    // j in [0, count) with base_distance + pivot_distances[j] <
+    // distances[j], stores the shorter distance and sets hops[j] to
+    // 'base_hop'. Unreached pivot distances are skipped.
+    template<typename Weight>
+    void relax_row_scalar(Weight base_distance,
+                          std::uint16_t base_hop,
+                          const Weight* pivot_distances,
+                          Weight* distances,
+                          std::uint16_t* hops,
+                          std::size_t count) {
+        const Weight unreached = unreached_distance<Weight>();
+
+        for (std::size_t j = 0; j < count; ++j) {
+            if (pivot_distances[j] == unreached) {
+                continue;
+            }
+
+            Weight tentative_distance = base_distance + pivot_distances[j];
+
+            if (distances[j] > tentative_distance) {
+                distances[j] = tentative_distance;
+                hops[j] = base_hop;
+            }
+        }
+    }
+
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+
+    __attribute__((target("avx2")))
+    inline void relax_row_avx2(std::int32_t base_distance,
+                               std::uint16_t base_hop,
+                               const std::int32_t* pivot_distances,
+                               std::int32_t* distances,
+                               std::uint16_t* hops,
+                               std::size_t count) {
+        std::size_t j = 0;
+        const __m256i base = _mm256_set1_epi32(base_distance);
+        const __m256i unreached = _mm256_set1_epi32(
+                                unreached_distance<std::int32_t>());
+        const __m128i hop = _mm_set1_epi16(static_cast<short>(base_hop));
+
+        for (; j + 8 <= count; j += 8) {
+            __m256i pivot = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(pivot_distances + j));
+            __m256i current = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(distances + j));
+            __m256i tentative = _mm256_add_epi32(base, pivot);
+            __m256i better = _mm256_andnot_si256(
+                                    _mm256_cmpeq_epi32(pivot, unreached),
+                                    _mm256_cmpgt_epi32(current, tentative));
+
+            if (_mm256_testz_si256(better, better)) {
+                continue;
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(distances + j),
+                                _mm256_blendv_epi8(current, tentative, better));
+
+            // Narrows the lane mask to the 16-bit hops.
+            __m128i hop_mask = _mm_packs_epi32(
+                                    _mm256_castsi256_si128(better),
+                                    _mm256_extracti128_si256(better, 1));
+            __m128i current_hops = _mm_loadu_si128(
+                                    reinterpret_cast<const __m128i*>(hops + j));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(hops + j),
+                             _mm_blendv_epi8(current_hops, hop, hop_mask));
+        }
+
+        relax_row_scalar(base_distance,
+                         base_hop,
+                         pivot_distances + j,
+                         distances + j,
+                         hops + j,
+                         count - j);
+    }
+
+    __attribute__((target("avx2")))
+    inline void relax_row_avx2(float base_distance,
+                               std::uint16_t base_hop,
+                               const float* pivot_distances,
+                               float* distances,
+                               std::uint16_t* hops,
+                               std::size_t count) {
+        std::size_t j = 0;
+        const __m256 base = _mm256_set1_ps(base_distance);
+        const __m128i hop = _mm_set1_epi16(static_cast<short>(base_hop));
+
+        // Infinite pivot distances give infinite sums, which are never
+        // better.
+        for (; j + 8 <= count; j += 8) {
+            __m256 pivot = _mm256_loadu_ps(pivot_distances + j);
+            __m256 current = _mm256_loadu_ps(distances + j);
+            __m256 tentative = _mm256_add_ps(base, pivot);
+            __m256 better = _mm256_cmp_ps(current, tentative, _CMP_GT_OQ);
+
+            if (_mm256_movemask_ps(better) == 0) {
+                continue;
+            }
+
+            _mm256_storeu_ps(distances + j,
+                             _mm256_blendv_ps(current, tentative, better));
+
+            __m256i lane_mask = _mm256_castps_si256(better);
+            __m128i hop_mask = _mm_packs_epi32(
+                                    _mm256_castsi256_si128(lane_mask),
+                                    _mm256_extracti128_si256(lane_mask, 1));
+            __m128i current_hops = _mm_loadu_si128(
+                                    reinterpret_cast<const __m128i*>(hops + j));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(hops + j),
+                             _mm_blendv_epi8(current_hops, hop, hop_mask));
+        }
+
+        relax_row_scalar(base_distance,
+                         base_hop,
+                         pivot_distances + j,
+                         distances + j,
+                         hops + j,
+                         count - j);
+    }
+
+#endif // NET_CODERODDE_PATHFINDING_X86_SIMD
+
+    // Rows of other weight types are relaxed one entry at a time.
+    template<typename Weight>
+    void relax_row(Weight base_distance,
+                   std::uint16_t base_hop,
+                   const Weight* pivot_distances,
+                   Weight* distances,
+                   std::uint16_t* hops,
+                   std::size_t count) {
+        relax_row_scalar(base_distance,
+                         base_hop,
+                         pivot_distances,
+                         distances,
+                         hops,
+                         count);
+    }
+
+    inline void relax_row(std::int32_t base_distance,
+                          std::uint16_t base_hop,
+                          const std::int32_t* pivot_distances,
+                          std::int32_t* distances,
+                          std::uint16_t* hops,
+                          std::size_t count) {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+        if (supported_simd_level() != simd_level::scalar) {
+            relax_row_avx2(base_distance,
+                           base_hop,
+                           pivot_distances,
+                           distances,
+                           hops,
+                           count);
+            return;
+        }
+#endif
+        relax_row_scalar(base_distance,
+                         base_hop,
+                         pivot_distances,
+                         distances,
+                         hops,
+                         count);
+    }
+
+    inline void relax_row(float base_distance,
+                          std::uint16_t base_hop,
+                          const float* pivot_distances,
+                          float* distances,
+                          std::uint16_t* hops,
+                          std::size_t count) {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+        if (supported_simd_level() != simd_level::scalar) {
+            relax_row_avx2(base_distance,
+                           base_hop,
+                           pivot_distances,
+                           distances,
+                           hops,
+                           count);
+            return;
+        }
+#endif
+        relax_row_scalar(base_distance,
+                         base_hop,
+                         pivot_distances,
+                         distances,
+                         hops,
+                         count);
+    }
+
+    enum class all_pairs_method {
+        automatic,
+        floyd_warshall,
+        repeated_dijkstra
+    };
+
+    // Shortest path distances between all pairs of nodes of a small graph,
+    // for graphs that are queried far more often than they change. Holds an
+    // n x n distance matrix and an n x n matrix of 16-bit next hops, so
+    // 'total_weight()' is a table lookup and 'path()' walks the next hops;
+    // graphs of more than 65535 nodes are rejected. Edge weights must not be
+    // negative.
+    //
+    // Dense graphs are solved with a blocked Floyd-Warshall whose blocks fit
+    // into the cache and whose rows are relaxed with vector instructions;
+    // sparse graphs run one Dijkstra search per source. Both are spread over
+    // all cores. Queries are read-only and may run concurrently.
+    template<typename Node, typename Weight>
+    class distance_oracle {
+    public:
+        explicit distance_oracle(
+                    const contiguous_graph<Node, Weight>& graph,
+                    all_pairs_method method = all_pairs_method::automatic)
+        :
+        m_graph{graph},
+        m_node_count{graph.node_count()}
+        {
+            static_assert(std::is_arithmetic<Weight>::value,
+                          "distance_oracle needs an arithmetic weight.");
+
+            if (m_node_count > no_hop) {
+                throw std::invalid_argument{
+                    "Too many nodes for a distance oracle."};
+            }
+
+            m_distances.assign(m_node_count * m_node_count,
+                               unreached_distance<Weight>());
+            m_hops.assign(m_node_count * m_node_count, no_hop);
+
+            if (method == all_pairs_method::automatic) {
+                method = m_graph.edge_count() * dense_degree_divisor
+                         < m_node_count * m_node_count ?
+                         all_pairs_method::repeated_dijkstra :
+                         all_pairs_method::floyd_warshall;
+            }
+
+            if (method == all_pairs_method::floyd_warshall) {
+                run_floyd_warshall();
+            } else {
+                run_repeated_dijkstra();
+            }
+        }
+
+        distance_oracle(const std::vector<Node*>& nodes,
+                        const weight_function<Node, Weight>& w,
+                        all_pairs_method method = all_pairs_method::automatic)
+        :
+        distance_oracle{contiguous_graph<Node, Weight>(nodes, w), method}
+        {}
+
+        std::size_t node_count() const {
+            return m_node_count;
+        }
+
+        const contiguous_graph<Node, Weight>& graph() const {
+            return m_graph;
+        }
+
+        bool is_reachable(Node& source, Node& target) const {
+            return hop(m_graph.id_of(source), m_graph.id_of(target)) != no_hop;
+        }
+
+        Weight total_weight(Node& source, Node& target) const {
+            std::size_t index = m_graph.id_of(source) * m_node_count
+                              + m_graph.id_of(target);
+
+            if (m_hops[index] == no_hop) {
+                throw path_not_found_exception<Node>(source, target);
+            }
+
+            return m_distances[index];
+        }
+
+        weighted_path<Node, Weight> path(Node& source, Node& target) const {
+            const std::uint32_t source_id = m_graph.id_of(source);
+            const std::uint32_t target_id = m_graph.id_of(target);
+            std::uint32_t id = source_id;
+
+            if (hop(id, target_id) == no_hop) {
+                throw path_not_found_exception<Node>(source, target);
+            }
+
+            std::vector<Node*> path{&m_graph.node_at(id)};
+
+            while (id != target_id) {
+                id = hop(id, target_id);
+                path.push_back(&m_graph.node_at(id));
+            }
+
+            return weighted_path<Node, Weight>(
+                        path,
+                        m_distances[source_id * m_node_count + target_id]);
+        }
+
+    private:
+        static const std::uint16_t no_hop = 0xffff;
+
+        // A 'block_size' x 'block_size' block of the matrices fits into the
+        // L1 or L2 cache.
+        static const std::size_t block_size = 64;
+
+        // Graphs with fewer than n / 'dense_degree_divisor' edges per node
+        // on average are searched from every source instead.
+        static const std::size_t dense_degree_divisor = 8;
+
+        // The node following 'id' on a shortest path to 'target_id'.
+        std::uint16_t hop(std::uint32_t id, std::uint32_t target_id) const {
+            return m_hops[id * m_node_count + target_id];
+        }
+
+        // Relaxes rows [row_begin, row_end) of the columns
+        // [column_begin, column_end) through the pivots
+        // [pivot_begin, pivot_end).
+        void relax_block(std::size_t row_begin,
+                         std::size_t row_end,
+                         std::size_t column_begin,
+                         std::size_t column_end,
+                         std::size_t pivot_begin,
+                         std::size_t pivot_end) {
+            const Weight unreached = unreached_distance<Weight>();
+            const std::size_t n = m_node_count;
+
+            for (std::size_t k = pivot_begin; k < pivot_end; ++k) {
+                for (std::size_t i = row_begin; i < row_end; ++i) {
+                    Weight base_distance = m_distances[i * n + k];
+
+                    if (base_distance == unreached) {
+                        continue;
+                    }
+
+                    relax_row(base_distance,
+                              m_hops[i * n + k],
+                              &m_distances[k * n + column_begin],
+                              &m_distances[i * n + column_begin],
+                              &m_hops[i * n + column_begin],
+                              column_end - column_begin);
+                }
+            }
+        }
+
+        // Blocked Floyd-Warshall: for each diagonal block, relaxes the
+        // diagonal block itself, then the blocks sharing its rows or
+        // columns, then all other blocks. The blocks of the last two phases
+        // are independent of each other and are relaxed in parallel.
+        void run_floyd_warshall() {
+            const std::size_t n = m_node_count;
+
+            for (std::uint32_t id = 0; id < n; ++id) {
+                m_distances[id * n + id] = Weight{};
+                m_hops[id * n + id] = static_cast<std::uint16_t>(id);
+
+                const std::uint32_t* heads = m_graph.heads(id);
+                const Weight* weights = m_graph.weights(id);
+
+                for (std::size_t e = 0; e < m_graph.degree(id); ++e) {
+                    std::size_t index = id * n + heads[e];
+
+                    if (m_distances[index] > weights[e]) {
+                        m_distances[index] = weights[e];
+                        m_hops[index] = static_cast<std::uint16_t>(heads[e]);
+                    }
+                }
+            }
+
+            const std::size_t blocks = (n + block_size - 1) / block_size;
+
+            auto block_begin = [=](std::size_t block) {
+                return block * block_size;
+            };
+
+            auto block_end = [=](std::size_t block) {
+                return std::min(n, (block + 1) * block_size);
+            };
+
+            for (std::size_t pivot = 0; pivot < blocks; ++pivot) {
+                const std::size_t pivot_begin = block_begin(pivot);
+                const std::size_t pivot_end = block_end(pivot);
+
+                relax_block(pivot_begin,
+                            pivot_end,
+                            pivot_begin,
+                            pivot_end,
+                            pivot_begin,
+                            pivot_end);
+
+                // Tasks [0, blocks) are the blocks in the pivot rows, tasks
+                // [blocks, 2 * blocks) those in the pivot columns.
+                parallel_for(2 * blocks, [&](std::size_t task) {
+                    std::size_t other = task % blocks;
+
+                    if (other == pivot) {
+                        return;
+                    }
+
+                    if (task < blocks) {
+                        relax_block(pivot_begin,
+                                    pivot_end,
+                                    block_begin(other),
+                                    block_end(other),
+                                    pivot_begin,
+                                    pivot_end);
+                    } else {
+                        relax_block(block_begin(other),
+                                    block_end(other),
+                                    pivot_begin,
+                                    pivot_end,
+                                    pivot_begin,
+                                    pivot_end);
+                    }
+                });
+
+                parallel_for(blocks, [&](std::size_t row) {
+                    if (row == pivot) {
+                        return;
+                    }
+
+                    for (std::size_t column = 0; column < blocks; ++column) {
+                        if (column != pivot) {
+                            relax_block(block_begin(row),
+                                        block_end(row),
+                                        block_begin(column),
+                                        block_end(column),
+                                        pivot_begin,
+                                        pivot_end);
+                        }
+                    }
+                });
+            }
+        }
+
+        // Runs Dijkstra from every source, 'block_size' sources per task.
+        // The first hop of a node is inherited from its parent.
+        void run_repeated_dijkstra() {
+            const std::size_t n = m_node_count;
+            const std::size_t tasks = (n + block_size - 1) / block_size;
+
+            parallel_for(tasks, [&](std::size_t task) {
+                std::vector<char> closed(n);
+                std::vector<std::uint32_t> improved_ids(m_graph.max_degree());
+                std::vector<Weight> improved_distances(m_graph.max_degree());
+
+                auto cmp = [](const id_holder<Weight>& ih1,
+                              const id_holder<Weight>& ih2) {
+                    return ih1.m_f > ih2.m_f;
+                };
+
+                std::priority_queue<id_holder<Weight>,
+                                    std::vector<id_holder<Weight>>,
+                                    decltype(cmp)> open(cmp);
+
+                for (std::size_t source = task * block_size;
+                     source < std::min(n, (task + 1) * block_size);
+                     ++source) {
+                    Weight* distances = &m_distances[source * n];
+                    std::uint16_t* hops = &m_hops[source * n];
+                    std::fill(closed.begin(), closed.end(), 0);
+
+                    distances[source] = Weight{};
+                    hops[source] = static_cast<std::uint16_t>(source);
+                    open.push(id_holder<Weight>(
+                                    static_cast<std::uint32_t>(source),
+                                    Weight{}));
+
+                    while (!open.empty()) {
+                        std::uint32_t current_id = open.top().m_id;
+                        open.pop();
+
+                        if (closed[current_id]) {
+                            continue;
+                        }
+
+                        closed[current_id] = 1;
+
+                        std::size_t improved = relax_open_edges(
+                                                m_graph.heads(current_id),
+                                                m_graph.weights(current_id),
+                                                m_graph.degree(current_id),
+                                                distances,
+                                                closed.data(),
+                                                distances[current_id],
+                                                improved_ids.data(),
+                                                improved_distances.data());
+
+                        for (std::size_t i = 0; i < improved; ++i) {
+                            std::uint32_t child_id = improved_ids[i];
+                            hops[child_id] =
+                            current_id == source ?
+                            static_cast<std::uint16_t>(child_id) :
+                            hops[current_id];
+                            open.push(id_holder<Weight>(
+                                                child_id,
+                                                improved_distances[i]));
+                        }
+                    }
+                }
+            });
+        }
+
+        contiguous_graph<Node, Weight> m_graph;
+        std::size_t                    m_node_count;
+        std::vector<Weight>            m_distances;
+        std::vector<std::uint16_t>     m_hops;
+    };
+
+    template<typename Node, typename Weight>
+    const std::uint16_t distance_oracle<Node, Weight>::no_hop;
+
+    template<typename Node, typename Weight>
+    const std::size_t distance_oracle<Node, Weight>::block_size;
+
+    template<typename Node, typename Weight>
+    const std::size_t distance_oracle<Node, Weight>::dense_degree_divisor;
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_DISTANCE_ORACLE_HPP
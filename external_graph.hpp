@@ -0,0 +1,473 @@
+#ifndef NET_CODERODDE_PATHFINDING_EXTERNAL_GRAPH_HPP
+#define NET_CODERODDE_PATHFINDING_EXTERNAL_GRAPH_HPP
+
+#include "contiguous_graph.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/types.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Graphs stored on disk in blocks of consecutive nodes. Uses POSIX file I/O.
+//
+// File layout (host byte order):
+//   header:    magic "PFGRAPH1", uint32 sizeof(Weight), uint32 nodes per
+//              block, uint64 node count, uint64 edge count, uint64 offset of
+//              the block directory
+//   blocks:    for a block of k nodes with e edges: uint32 offsets[k + 1]
+//              (relative to the block), uint32 heads[e], padding to 8 bytes,
+//              Weight weights[e]
+//   directory: uint64 offset and uint64 byte length of every block
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    const char external_graph_magic[8] = { 'P', 'F', 'G', 'R', 'A', 'P', 'H', '1' };
+
+    struct external_graph_header {
+        char          m_magic[8];
+        std::uint32_t m_weight_size;
+        std::uint32_t m_block_node_count;
+        std::uint64_t m_node_count;
+        std::uint64_t m_edge_count;
+        std::uint64_t m_directory_offset;
+    };
+
+    // Block I/O and state spilling statistics of an out-of-core search.
+    struct io_counters {
+        std::uint64_t m_block_reads    = 0;
+        std::uint64_t m_bytes_read     = 0;
+        std::uint64_t m_cache_hits     = 0;
+        std::uint64_t m_cache_misses   = 0;
+        std::uint64_t m_prefetches     = 0;
+        std::uint64_t m_spilled_bytes  = 0;
+    };
+
+    inline void write_fully(int fd, const void* data, std::size_t length) {
+        const char* bytes = static_cast<const char*>(data);
+
+        while (length > 0) {
+            ssize_t written = ::write(fd, bytes, length);
+
+            if (written <= 0) {
+                throw std::runtime_error{"Writing a graph file failed."};
+            }
+
+            bytes += written;
+            length -= static_cast<std::size_t>(written);
+        }
+    }
+
+    inline void read_fully(int fd, void* data, std::size_t length, off_t offset) {
+        char* bytes = static_cast<char*>(data);
+
+        while (length > 0) {
+            ssize_t got = ::pread(fd, bytes, length, offset);
+
+            if (got <= 0) {
+                throw std::runtime_error{"Reading a graph file failed."};
+            }
+
+            bytes += got;
+            length -= static_cast<std::size_t>(got);
+            offset += got;
+        }
+    }
+
+    // Writes a graph file node by node, so that graphs larger than memory can
+    // be converted. Nodes get ids 0, 1, ... in the order they are added.
+    template<typename Weight>
+    class external_graph_writer {
+    public:
+        external_graph_writer(const std::string& file_name,
+                              std::uint32_t block_node_count = 4096)
+        :
+        m_block_node_count{block_node_count},
+        m_node_count{0},
+        m_edge_count{0},
+        m_closed{false}
+        {
+            static_assert(std::is_trivially_copyable<Weight>::value,
+                          "Weights must be trivially copyable.");
+
+            if (block_node_count == 0) {
+                throw std::invalid_argument{
+                    "block_node_count must be positive."};
+            }
+
+            m_fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+            if (m_fd < 0) {
+                throw std::runtime_error{"Cannot create " + file_name};
+            }
+
+            external_graph_header header{};
+            write_fully(m_fd, &header, sizeof(header));
+            m_file_size = sizeof(header);
+            m_block_offsets.push_back(0);
+        }
+
+        external_graph_writer(const external_graph_writer&) = delete;
+        external_graph_writer& operator=(const external_graph_writer&) = delete;
+
+        ~external_graph_writer() {
+            if (!m_closed) {
+                try {
+                    close();
+                } catch (...) {
+                }
+            }
+        }
+
+        void add_node(const std::uint32_t* heads,
+                      const Weight* weights,
+                      std::size_t degree) {
+            m_block_heads.insert(m_block_heads.end(), heads, heads + degree);
+            m_block_weights.insert(m_block_weights.end(),
+                                   weights,
+                                   weights + degree);
+            m_block_offsets.push_back(
+                        static_cast<std::uint32_t>(m_block_heads.size()));
+            ++m_node_count;
+            m_edge_count += degree;
+
+            if (m_block_offsets.size() == m_block_node_count + 1) {
+                flush_block();
+            }
+        }
+
+        void close() {
+            if (m_closed) {
+                return;
+            }
+
+            m_closed = true;
+
+            if (m_block_offsets.size() > 1) {
+                flush_block();
+            }
+
+            external_graph_header header{};
+            std::memcpy(header.m_magic,
+                        external_graph_magic,
+                        sizeof(header.m_magic));
+            header.m_weight_size = sizeof(Weight);
+            header.m_block_node_count = m_block_node_count;
+            header.m_node_count = m_node_count;
+            header.m_edge_count = m_edge_count;
+            header.m_directory_offset = m_file_size;
+
+            write_fully(m_fd,
+                        m_directory.data(),
+                        m_directory.size() * sizeof(std::uint64_t));
+
+            if (::pwrite(m_fd, &header, sizeof(header), 0) !=
+                static_cast<ssize_t>(sizeof(header))) {
+                ::close(m_fd);
+                throw std::runtime_error{"Writing a graph file failed."};
+            }
+
+            if (::close(m_fd) != 0) {
+                throw std::runtime_error{"Writing a graph file failed."};
+            }
+        }
+
+    private:
+        void flush_block() {
+            std::uint64_t start = m_file_size;
+            std::size_t heads_bytes = m_block_heads.size() * sizeof(std::uint32_t);
+            std::size_t offsets_bytes =
+            m_block_offsets.size() * sizeof(std::uint32_t);
+            std::size_t padding = (8 - (offsets_bytes + heads_bytes) % 8) % 8;
+            const char zeros[8] = {};
+
+            write_fully(m_fd, m_block_offsets.data(), offsets_bytes);
+            write_fully(m_fd, m_block_heads.data(), heads_bytes);
+            write_fully(m_fd, zeros, padding);
+            write_fully(m_fd,
+                        m_block_weights.data(),
+                        m_block_weights.size() * sizeof(Weight));
+
+            m_file_size += offsets_bytes + heads_bytes + padding +
+                           m_block_weights.size() * sizeof(Weight);
+
+            m_directory.push_back(start);
+            m_directory.push_back(m_file_size - start);
+
+            m_block_offsets.assign(1, 0);
+            m_block_heads.clear();
+            m_block_weights.clear();
+        }
+
+        int                        m_fd;
+        std::uint32_t              m_block_node_count;
+        std::uint64_t              m_node_count;
+        std::uint64_t              m_edge_count;
+        std::uint64_t              m_file_size;
+        bool                       m_closed;
+        std::vector<std::uint32_t> m_block_offsets;
+        std::vector<std::uint32_t> m_block_heads;
+        std::vector<Weight>        m_block_weights;
+        std::vector<std::uint64_t> m_directory;
+    };
+
+    template<typename Node, typename Weight>
+    void write_external_graph(const contiguous_graph<Node, Weight>& graph,
+                              const std::string& file_name,
+                              std::uint32_t block_node_count = 4096) {
+        external_graph_writer<Weight> writer(file_name, block_node_count);
+
+        for (std::uint32_t id = 0; id < graph.node_count(); ++id) {
+            writer.add_node(graph.heads(id), graph.weights(id), graph.degree(id));
+        }
+
+        writer.close();
+    }
+
+    // A read-only graph file accessed through an LRU cache of blocks holding
+    // at most 'cache_bytes' bytes (but always at least one block). Blocks
+    // that the search is likely to need soon can be announced with
+    // 'prefetch()', which asks the kernel to start reading them in the
+    // background.
+    template<typename Weight>
+    class external_graph {
+    public:
+        external_graph(const std::string& file_name, std::size_t cache_bytes)
+        :
+        m_cache_bytes{cache_bytes},
+        m_cached_bytes{0}
+        {
+            m_fd = ::open(file_name.c_str(), O_RDONLY);
+
+            if (m_fd < 0) {
+                throw std::runtime_error{"Cannot open " + file_name};
+            }
+
+            try {
+                read_fully(m_fd, &m_header, sizeof(m_header), 0);
+
+                if (std::memcmp(m_header.m_magic,
+                                external_graph_magic,
+                                sizeof(m_header.m_magic)) != 0
+                    || m_header.m_weight_size != sizeof(Weight)
+                    || m_header.m_block_node_count == 0
+                    || m_header.m_node_count >
+                       static_cast<std::uint64_t>(INT32_MAX)) {
+                    throw std::runtime_error{
+                        file_name + " is not a graph file of this weight type."};
+                }
+
+                std::size_t block_count = static_cast<std::size_t>(
+                    (m_header.m_node_count + m_header.m_block_node_count - 1)
+                    / m_header.m_block_node_count);
+
+                m_directory.resize(2 * block_count);
+                read_fully(m_fd,
+                           m_directory.data(),
+                           m_directory.size() * sizeof(std::uint64_t),
+                           static_cast<off_t>(m_header.m_directory_offset));
+            } catch (...) {
+                ::close(m_fd);
+                throw;
+            }
+        }
+
+        external_graph(const external_graph&) = delete;
+        external_graph& operator=(const external_graph&) = delete;
+
+        ~external_graph() {
+            ::close(m_fd);
+        }
+
+        std::size_t node_count() const {
+            return static_cast<std::size_t>(m_header.m_node_count);
+        }
+
+        std::size_t edge_count() const {
+            return static_cast<std::size_t>(m_header.m_edge_count);
+        }
+
+        // Makes the edges of node 'id' available in 'heads' and 'weights'.
+        // The pointers stay valid until the next call to 'edges()'.
+        std::size_t edges(std::uint32_t id,
+                          const std::uint32_t*& heads,
+                          const Weight*& weights) {
+            if (id >= m_header.m_node_count) {
+                throw std::out_of_range{"The node is not in the graph."};
+            }
+
+            const cached_block& block = load_block(id / block_node_count());
+            std::uint32_t local = id % block_node_count();
+
+            heads = block.m_heads + block.m_offsets[local];
+            weights = block.m_weights + block.m_offsets[local];
+            return block.m_offsets[local + 1] - block.m_offsets[local];
+        }
+
+        // Starts reading the block holding node 'id' unless it is cached.
+        void prefetch(std::uint32_t id) {
+            std::size_t block = id / block_node_count();
+
+            if (m_blocks.find(block) != m_blocks.end()
+                || !m_prefetched.insert(block).second) {
+                return;
+            }
+
+#ifdef POSIX_FADV_WILLNEED
+            ::posix_fadvise(m_fd,
+                            static_cast<off_t>(m_directory[2 * block]),
+                            static_cast<off_t>(m_directory[2 * block + 1]),
+                            POSIX_FADV_WILLNEED);
+#endif
+            ++m_counters.m_prefetches;
+        }
+
+        const io_counters& counters() const {
+            return m_counters;
+        }
+
+        void reset_counters() {
+            m_counters = io_counters{};
+        }
+
+    private:
+        struct cached_block {
+            std::vector<std::uint64_t>        m_storage;
+            const std::uint32_t*              m_offsets;
+            const std::uint32_t*              m_heads;
+            const Weight*                     m_weights;
+            std::list<std::size_t>::iterator  m_lru_position;
+        };
+
+        std::uint32_t block_node_count() const {
+            return m_header.m_block_node_count;
+        }
+
+        const cached_block& load_block(std::size_t block) {
+            auto it = m_blocks.find(block);
+
+            if (it != m_blocks.end()) {
+                ++m_counters.m_cache_hits;
+                m_lru.splice(m_lru.begin(), m_lru, it->second->m_lru_position);
+                return *it->second;
+            }
+
+            ++m_counters.m_cache_misses;
+
+            std::uint64_t offset = m_directory[2 * block];
+            std::uint64_t length = m_directory[2 * block + 1];
+            std::uint64_t first_node =
+            static_cast<std::uint64_t>(block) * block_node_count();
+            std::size_t node_count = static_cast<std::size_t>(
+                std::min<std::uint64_t>(block_node_count(),
+                                        m_header.m_node_count - first_node));
+
+            std::unique_ptr<cached_block> entry(new cached_block);
+            entry->m_storage.resize(static_cast<std::size_t>((length + 7) / 8));
+            read_fully(m_fd,
+                       entry->m_storage.data(),
+                       static_cast<std::size_t>(length),
+                       static_cast<off_t>(offset));
+
+            const char* bytes =
+            reinterpret_cast<const char*>(entry->m_storage.data());
+            std::size_t offsets_bytes = (node_count + 1) * sizeof(std::uint32_t);
+
+            if (offsets_bytes > length) {
+                throw std::runtime_error{"Corrupt graph block."};
+            }
+
+            entry->m_offsets = reinterpret_cast<const std::uint32_t*>(bytes);
+
+            // The offsets must start at zero and never decrease, or
+            // 'edges()' would compute a wrapped-around degree.
+            if (entry->m_offsets[0] != 0) {
+                throw std::runtime_error{"Corrupt graph block."};
+            }
+
+            for (std::size_t i = 0; i < node_count; ++i) {
+                if (entry->m_offsets[i] > entry->m_offsets[i + 1]) {
+                    throw std::runtime_error{"Corrupt graph block."};
+                }
+            }
+
+            std::size_t edge_count = entry->m_offsets[node_count];
+
+            if (edge_count > m_header.m_edge_count) {
+                throw std::runtime_error{"Corrupt graph block."};
+            }
+
+            std::size_t heads_end = offsets_bytes
+                                  + edge_count * sizeof(std::uint32_t);
+            std::size_t weights_begin = (heads_end + 7) / 8 * 8;
+
+            if (weights_begin + edge_count * sizeof(Weight) > length) {
+                throw std::runtime_error{"Corrupt graph block."};
+            }
+
+            entry->m_heads = reinterpret_cast<const std::uint32_t*>(
+                            bytes + offsets_bytes);
+            entry->m_weights = reinterpret_cast<const Weight*>(
+                            bytes + weights_begin);
+
+            for (std::size_t i = 0; i < edge_count; ++i) {
+                if (entry->m_heads[i] >= m_header.m_node_count) {
+                    throw std::runtime_error{"Corrupt graph block."};
+                }
+            }
+
+            ++m_counters.m_block_reads;
+            m_counters.m_bytes_read += length;
+            m_prefetched.erase(block);
+
+            std::size_t entry_bytes = entry->m_storage.size() * 8;
+
+            while (!m_lru.empty()
+                   && m_cached_bytes + entry_bytes > m_cache_bytes) {
+                evict_least_recently_used();
+            }
+
+            m_lru.push_front(block);
+            entry->m_lru_position = m_lru.begin();
+            m_cached_bytes += entry_bytes;
+
+            cached_block& result = *entry;
+            m_blocks[block] = std::move(entry);
+            return result;
+        }
+
+        void evict_least_recently_used() {
+            std::size_t block = m_lru.back();
+            auto it = m_blocks.find(block);
+            m_cached_bytes -= it->second->m_storage.size() * 8;
+            m_blocks.erase(it);
+            m_lru.pop_back();
+        }
+
+        int                        m_fd;
+        external_graph_header      m_header;
+        std::vector<std::uint64_t> m_directory;
+        std::size_t                m_cache_bytes;
+        std::size_t                m_cached_bytes;
+        std::list<std::size_t>     m_lru;
+        std::unordered_map<std::size_t, std::unique_ptr<cached_block>> m_blocks;
+        std::unordered_set<std::size_t> m_prefetched;
+        io_counters                m_counters;
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_EXTERNAL_GRAPH_HPP
@@ -0,0 +1,456 @@
+#ifndef NET_CODERODDE_PATHFINDING_EXTERNAL_SEARCH_HPP
+#define NET_CODERODDE_PATHFINDING_EXTERNAL_SEARCH_HPP
+
+#include "contiguous_search.hpp"
+#include "external_graph.hpp"
+#include "heuristic_function.hpp"
+#include "relaxation_kernel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // A per-node search state array. It lives in memory while it fits into
+    // what is left of 'memory_budget' (which is then reduced by its size);
+    // otherwise, or once 'spill()' is called, it is mapped from an unlinked
+    // temporary file, so the kernel can write its pages out instead of
+    // holding all of them in RAM.
+    template<typename T>
+    class state_array {
+    public:
+        state_array(std::size_t size,
+                    T initial,
+                    std::size_t& memory_budget,
+                    io_counters& counters)
+        :
+        m_mapped{nullptr},
+        m_mapped_bytes{0}
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "State must be trivially copyable.");
+
+            std::size_t bytes = size * sizeof(T);
+
+            if (bytes <= memory_budget) {
+                memory_budget -= bytes;
+                m_memory.assign(size, initial);
+                m_data = m_memory.data();
+                return;
+            }
+
+            map_spill_file(bytes, counters);
+            std::fill(m_data, m_data + size, initial);
+        }
+
+        state_array(const state_array&) = delete;
+        state_array& operator=(const state_array&) = delete;
+
+        ~state_array() {
+            if (m_mapped) {
+                ::munmap(m_mapped, m_mapped_bytes);
+            }
+        }
+
+        T& operator[](std::size_t index) {
+            return m_data[index];
+        }
+
+        T* data() {
+            return m_data;
+        }
+
+        bool spilled() const {
+            return m_mapped != nullptr;
+        }
+
+        // Moves an array held in memory to a spill file. Returns the number
+        // of bytes of memory released, 0 if the array was already spilled.
+        std::size_t spill(io_counters& counters) {
+            if (spilled() || m_memory.empty()) {
+                return 0;
+            }
+
+            std::size_t bytes = m_memory.size() * sizeof(T);
+            map_spill_file(bytes, counters);
+            std::copy(m_memory.begin(), m_memory.end(), m_data);
+            std::vector<T>().swap(m_memory);
+            return bytes;
+        }
+
+    private:
+        void map_spill_file(std::size_t bytes, io_counters& counters) {
+            const char* directory = std::getenv("TMPDIR");
+            std::string file_name = std::string(directory ? directory : "/tmp")
+                                  + "/pathfinding-state-XXXXXX";
+            int fd = ::mkstemp(&file_name[0]);
+
+            if (fd < 0) {
+                throw std::runtime_error{"Cannot create a spill file."};
+            }
+
+            ::unlink(file_name.c_str());
+
+            if (bytes > 0
+                && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                ::close(fd);
+                throw std::runtime_error{"Cannot grow a spill file."};
+            }
+
+            void* mapped = bytes > 0 ? ::mmap(nullptr,
+                                              bytes,
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_SHARED,
+                                              fd,
+                                              0)
+                                     : nullptr;
+            ::close(fd);
+
+            if (mapped == MAP_FAILED) {
+                throw std::runtime_error{"Cannot map a spill file."};
+            }
+
+            m_mapped = mapped;
+            m_mapped_bytes = bytes;
+            m_data = static_cast<T*>(mapped);
+            counters.m_spilled_bytes += bytes;
+        }
+
+        std::vector<T> m_memory;
+        void*          m_mapped;
+        std::size_t    m_mapped_bytes;
+        T*             m_data;
+    };
+
+    // Thrown when an 'external_graph' search finds no path. The nodes are
+    // plain ids, usually temporaries, so it keeps copies of them.
+    class external_path_not_found_exception : public virtual std::logic_error {
+    public:
+        external_path_not_found_exception(std::uint32_t source,
+                                          std::uint32_t target)
+        :
+        std::logic_error{"A path from source {" + std::to_string(source)
+                         + "} to target {" + std::to_string(target)
+                         + "} not found."},
+        m_source{source},
+        m_target{target}
+        {}
+
+        std::uint32_t source() const {
+            return m_source;
+        }
+
+        std::uint32_t target() const {
+            return m_target;
+        }
+
+    private:
+        std::uint32_t m_source;
+        std::uint32_t m_target;
+    };
+
+    // A path in an 'external_graph' as a list of node ids, with the I/O the
+    // query caused.
+    template<typename Weight>
+    class external_path {
+    public:
+        external_path(std::vector<std::uint32_t> path_vector,
+                      Weight total_weight,
+                      const io_counters& io)
+        :
+        m_path_vector{std::move(path_vector)},
+        m_total_weight{total_weight},
+        m_io{io}
+        {}
+
+        std::size_t size() const {
+            return m_path_vector.size();
+        }
+
+        std::uint32_t node_at(std::size_t index) const {
+            return m_path_vector.at(index);
+        }
+
+        Weight total_weight() const {
+            return m_total_weight;
+        }
+
+        const io_counters& io() const {
+            return m_io;
+        }
+
+    private:
+        std::vector<std::uint32_t> m_path_vector;
+        Weight                     m_total_weight;
+        io_counters                m_io;
+
+        friend std::ostream& operator<<(std::ostream& out,
+                                        const external_path& path) {
+            std::string separator{};
+            out << "[";
+
+            for (std::uint32_t id : path.m_path_vector) {
+                out << separator << id;
+                separator = ", ";
+            }
+
+            return out << "]";
+        }
+    };
+
+    inline io_counters io_since(const io_counters& before,
+                                const io_counters& now) {
+        io_counters delta;
+        delta.m_block_reads   = now.m_block_reads   - before.m_block_reads;
+        delta.m_bytes_read    = now.m_bytes_read    - before.m_bytes_read;
+        delta.m_cache_hits    = now.m_cache_hits    - before.m_cache_hits;
+        delta.m_cache_misses  = now.m_cache_misses  - before.m_cache_misses;
+        delta.m_prefetches    = now.m_prefetches    - before.m_prefetches;
+        delta.m_spilled_bytes = now.m_spilled_bytes - before.m_spilled_bytes;
+        return delta;
+    }
+
+    // A* over an 'external_graph'. Nodes are ids, so the heuristic is a
+    // 'heuristic_function<std::uint32_t, Weight>'. The distance, parent and
+    // closed arrays start in memory if they fit into 'memory_budget' bytes
+    // and in temporary files otherwise. The open list is charged against
+    // what they leave of the budget; whenever it outgrows that, the arrays
+    // still in memory move to files, the distances first, then the parents
+    // and then the closed flags. The open list itself always stays in
+    // memory. The blocks of every pushed node are prefetched.
+    template<typename Weight>
+    external_path<Weight> search(external_graph<Weight>& graph,
+                                 std::uint32_t source,
+                                 std::uint32_t target,
+                                 const heuristic_function<std::uint32_t, Weight>& h,
+                                 std::size_t memory_budget) {
+        static_assert(std::is_arithmetic<Weight>::value,
+                      "external_graph search needs an arithmetic weight.");
+
+        if (source >= graph.node_count() || target >= graph.node_count()) {
+            throw std::out_of_range{"The node is not in the graph."};
+        }
+
+        const std::uint32_t no_parent = std::numeric_limits<std::uint32_t>::max();
+        io_counters before = graph.counters();
+        io_counters spills;
+
+        state_array<Weight> distances(graph.node_count(),
+                                      unreached_distance<Weight>(),
+                                      memory_budget,
+                                      spills);
+        state_array<std::uint32_t> parents(graph.node_count(),
+                                           no_parent,
+                                           memory_budget,
+                                           spills);
+        state_array<char> closed(graph.node_count(), 0, memory_budget, spills);
+
+        std::vector<std::uint32_t> improved_ids;
+        std::vector<Weight> improved_distances;
+        std::vector<Weight> estimates;
+
+        auto cmp = [](const id_holder<Weight>& ih1, const id_holder<Weight>& ih2) {
+            return ih1.m_f > ih2.m_f;
+        };
+
+        std::priority_queue<id_holder<Weight>,
+                            std::vector<id_holder<Weight>>,
+                            decltype(cmp)> open(cmp);
+
+        open.push(id_holder<Weight>(source, Weight{}));
+        distances[source] = Weight{};
+
+        while (!open.empty()) {
+            std::uint32_t current_id = open.top().m_id;
+            open.pop();
+
+            if (current_id == target) {
+                std::vector<std::uint32_t> path;
+
+                for (std::uint32_t id = current_id;
+                     id != no_parent;
+                     id = parents[id]) {
+                    path.push_back(id);
+                }
+
+                std::reverse(path.begin(), path.end());
+
+                io_counters io = io_since(before, graph.counters());
+                io.m_spilled_bytes = spills.m_spilled_bytes;
+                return external_path<Weight>(std::move(path),
+                                             distances[target],
+                                             io);
+            }
+
+            if (closed[current_id]) {
+                continue;
+            }
+
+            closed[current_id] = 1;
+
+            const std::uint32_t* heads;
+            const Weight* weights;
+            std::size_t degree = graph.edges(current_id, heads, weights);
+
+            if (improved_ids.size() < degree) {
+                improved_ids.resize(degree);
+                improved_distances.resize(degree);
+                estimates.resize(degree);
+            }
+
+            std::size_t pushed = relax_open_edges(heads,
+                                                  weights,
+                                                  degree,
+                                                  distances.data(),
+                                                  closed.data(),
+                                                  distances[current_id],
+                                                  improved_ids.data(),
+                                                  improved_distances.data());
+
+            for (std::size_t i = 0; i < pushed; ++i) {
+                parents[improved_ids[i]] = current_id;
+                graph.prefetch(improved_ids[i]);
+            }
+
+            h.estimate_span(improved_ids.data(), pushed, estimates.data());
+
+            for (std::size_t i = 0; i < pushed; ++i) {
+                open.push(id_holder<Weight>(improved_ids[i],
+                                            improved_distances[i] +
+                                            estimates[i]));
+            }
+
+            while (open.size() * sizeof(id_holder<Weight>) > memory_budget) {
+                std::size_t released = distances.spill(spills);
+
+                if (released == 0) {
+                    released = parents.spill(spills);
+                }
+
+                if (released == 0) {
+                    released = closed.spill(spills);
+                }
+
+                if (released == 0) {
+                    break;
+                }
+
+                memory_budget += released;
+            }
+        }
+
+        throw external_path_not_found_exception(source, target);
+    }
+
+    template<typename Weight>
+    external_path<Weight> search(external_graph<Weight>& graph,
+                                 std::uint32_t source,
+                                 std::uint32_t target,
+                                 std::size_t memory_budget) {
+        zero_heuristic<std::uint32_t, Weight> h;
+        return search(graph, source, target, h, memory_budget);
+    }
+
+    template<typename Weight>
+    class external_heuristic_function_selector {
+    public:
+        external_heuristic_function_selector(external_graph<Weight>& graph,
+                                             std::uint32_t source,
+                                             std::uint32_t target)
+        :
+        m_graph{graph},
+        m_source{source},
+        m_target{target},
+        m_memory_budget{std::numeric_limits<std::size_t>::max()} {}
+
+        // Keeps the search state in memory up to 'bytes' bytes: the
+        // per-node arrays that do not fit from the start, and those the
+        // growing open list pushes out later, are moved to temporary files.
+        // The open list is never spilled.
+        external_heuristic_function_selector&
+        within_memory_budget(std::size_t bytes) {
+            m_memory_budget = bytes;
+            return *this;
+        }
+
+        external_path<Weight> without_heuristic_function() {
+            return search(m_graph, m_source, m_target, m_memory_budget);
+        }
+
+        external_path<Weight>
+        with_heuristic_function(
+                const heuristic_function<std::uint32_t, Weight>* heuristic_function) {
+            return search(m_graph,
+                          m_source,
+                          m_target,
+                          *heuristic_function,
+                          m_memory_budget);
+        }
+
+    private:
+        external_graph<Weight>& m_graph;
+        std::uint32_t           m_source;
+        std::uint32_t           m_target;
+        std::size_t             m_memory_budget;
+    };
+
+    template<typename Weight>
+    class external_target_node_selector {
+    public:
+        external_target_node_selector(external_graph<Weight>& graph,
+                                      std::uint32_t source)
+        :
+        m_graph{graph},
+        m_source{source} {}
+
+        external_heuristic_function_selector<Weight> to(std::uint32_t target) {
+            return external_heuristic_function_selector<Weight>(m_graph,
+                                                                m_source,
+                                                                target);
+        }
+
+    private:
+        external_graph<Weight>& m_graph;
+        std::uint32_t           m_source;
+    };
+
+    template<typename Weight>
+    class external_source_node_selector {
+    public:
+        external_source_node_selector(external_graph<Weight>& graph)
+        :
+        m_graph{graph} {}
+
+        external_target_node_selector<Weight> from(std::uint32_t source) {
+            return external_target_node_selector<Weight>(m_graph, source);
+        }
+
+    private:
+        external_graph<Weight>& m_graph;
+    };
+
+    // Searches a graph on disk; nodes are given by id. Like the rest of the
+    // out-of-core search this needs POSIX, so 'pathfinding.hpp' does not
+    // include it.
+    template<typename Weight>
+    external_source_node_selector<Weight>
+    find_shortest_path(external_graph<Weight>& graph) {
+        return external_source_node_selector<Weight>(graph);
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_EXTERNAL_SEARCH_HPP
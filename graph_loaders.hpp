@@ -0,0 +1,723 @@
+#ifndef NET_CODERODDE_PATHFINDING_GRAPH_LOADERS_HPP
+#define NET_CODERODDE_PATHFINDING_GRAPH_LOADERS_HPP
+
+#include "indexed_graph.hpp"
+#include "parallel_for.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+// Loaders for the DIMACS shortest path challenge formats (.gr graphs and
+// .co coordinates) and the MovingAI grid benchmarks (.map grids and .scen
+// scenarios). The files are mapped into memory, split into chunks of whole
+// lines and parsed in parallel; the adjacency arrays are then built in bulk.
+// Uses POSIX file I/O.
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // A read-only memory mapping of a whole file.
+    class mapped_file {
+    public:
+        explicit mapped_file(const std::string& file_name)
+        :
+        m_data{nullptr},
+        m_size{0}
+        {
+            int fd = ::open(file_name.c_str(), O_RDONLY);
+
+            if (fd < 0) {
+                throw std::runtime_error{"Cannot open " + file_name + "."};
+            }
+
+            struct stat status;
+
+            if (::fstat(fd, &status) != 0) {
+                ::close(fd);
+                throw std::runtime_error{"Cannot stat " + file_name + "."};
+            }
+
+            m_size = static_cast<std::size_t>(status.st_size);
+
+            if (m_size > 0) {
+                void* mapped = ::mmap(nullptr,
+                                      m_size,
+                                      PROT_READ,
+                                      MAP_PRIVATE,
+                                      fd,
+                                      0);
+
+                if (mapped == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error{"Cannot map " + file_name + "."};
+                }
+
+                ::madvise(mapped, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(mapped);
+            }
+
+            ::close(fd);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        ~mapped_file() {
+            if (m_data) {
+                ::munmap(const_cast<char*>(m_data), m_size);
+            }
+        }
+
+        const char* begin() const {
+            return m_data;
+        }
+
+        const char* end() const {
+            return m_data + m_size;
+        }
+
+    private:
+        const char* m_data;
+        std::size_t m_size;
+    };
+
+    inline void skip_blanks(const char*& p, const char* end) {
+        while (p != end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    // True if only blanks are left before the end of the line.
+    inline bool at_line_end(const char* p, const char* end) {
+        skip_blanks(p, end);
+        return p == end || *p == '\n';
+    }
+
+    inline const char* next_line(const char* p, const char* end) {
+        const void* newline = std::memchr(p, '\n', end - p);
+        return newline ? static_cast<const char*>(newline) + 1 : end;
+    }
+
+    // Parses a decimal number after optional blanks. Returns false, leaving
+    // 'p' anywhere, if there is none or it does not fit.
+    inline bool parse_unsigned(const char*& p,
+                               const char* end,
+                               std::uint64_t& value) {
+        const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+        skip_blanks(p, end);
+
+        if (p == end || *p < '0' || *p > '9') {
+            return false;
+        }
+
+        value = 0;
+
+        for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+            std::uint64_t digit = static_cast<std::uint64_t>(*p - '0');
+
+            if (value > (max - digit) / 10) {
+                return false;
+            }
+
+            value = 10 * value + digit;
+        }
+
+        return true;
+    }
+
+    inline bool parse_signed(const char*& p,
+                             const char* end,
+                             std::int64_t& value) {
+        skip_blanks(p, end);
+        bool negative = p != end && *p == '-';
+
+        if (p != end && (*p == '-' || *p == '+')) {
+            ++p;
+
+            if (p == end || *p < '0' || *p > '9') {
+                return false;
+            }
+        }
+
+        std::uint64_t magnitude;
+
+        if (!parse_unsigned(p, end, magnitude)
+            || magnitude > static_cast<std::uint64_t>(
+                                std::numeric_limits<std::int64_t>::max())) {
+            return false;
+        }
+
+        value = negative ? -static_cast<std::int64_t>(magnitude)
+                         : static_cast<std::int64_t>(magnitude);
+        return true;
+    }
+
+    // Reads the next run of non-blank characters.
+    inline bool parse_token(const char*& p,
+                            const char* end,
+                            const char*& token_begin,
+                            const char*& token_end) {
+        skip_blanks(p, end);
+        token_begin = p;
+
+        while (p != end
+               && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+            ++p;
+        }
+
+        token_end = p;
+        return token_begin != token_end;
+    }
+
+    inline bool token_equals(const char* token_begin,
+                             const char* token_end,
+                             const char* word) {
+        std::size_t length = std::strlen(word);
+        return static_cast<std::size_t>(token_end - token_begin) == length
+            && std::memcmp(token_begin, word, length) == 0;
+    }
+
+    // Hands every line in [begin, end) to 'parse_line(line, line_end,
+    // records)', where 'line_end' points at the newline or at 'end'. The
+    // text is split into chunks of about 'chunk_bytes' whole lines that are
+    // parsed in parallel, each into its own vector; the vectors are returned
+    // in file order.
+    template<typename Record, typename ParseLine>
+    std::vector<std::vector<Record>>
+    parse_lines_in_parallel(const char* begin,
+                            const char* end,
+                            ParseLine parse_line,
+                            std::size_t chunk_bytes = 1 << 20) {
+        std::vector<const char*> boundaries{begin};
+
+        while (boundaries.back() != end) {
+            const char* chunk_begin = boundaries.back();
+
+            if (static_cast<std::size_t>(end - chunk_begin) <= chunk_bytes) {
+                boundaries.push_back(end);
+            } else {
+                boundaries.push_back(next_line(chunk_begin + chunk_bytes, end));
+            }
+        }
+
+        std::vector<std::vector<Record>> records(boundaries.size() - 1);
+
+        parallel_for(records.size(), [&](std::size_t chunk) {
+            const char* line = boundaries[chunk];
+            const char* chunk_end = boundaries[chunk + 1];
+
+            while (line != chunk_end) {
+                const char* line_end = next_line(line, chunk_end);
+                parse_line(line,
+                           line_end[-1] == '\n' ? line_end - 1 : line_end,
+                           records[chunk]);
+                line = line_end;
+            }
+        });
+
+        return records;
+    }
+
+    // Finds the line starting with 'tag' (such as "p") before any line
+    // that is neither empty nor a comment ("c"). Returns its start, or 'end'.
+    inline const char* find_header_line(const char* begin,
+                                        const char* end,
+                                        char tag) {
+        for (const char* line = begin;
+             line != end;
+             line = next_line(line, end)) {
+            if (*line == tag) {
+                return line;
+            }
+
+            if (*line != 'c' && !at_line_end(line, end)) {
+                break;
+            }
+        }
+
+        return end;
+    }
+
+    template<typename Weight>
+    struct dimacs_arc {
+        std::uint32_t m_tail;
+        std::uint32_t m_head;
+        Weight        m_weight;
+    };
+
+    // Loads a DIMACS .gr file ("p sp <nodes> <arcs>" followed by
+    // "a <tail> <head> <weight>" lines, nodes numbered from 1) and, if
+    // 'co_file_name' is not empty, the matching .co file ("v <node> <x> <y>"
+    // lines). Node i of the file becomes node i - 1 of the graph; the edges
+    // of each node keep their file order. Throws 'std::runtime_error' on
+    // malformed input.
+    template<typename Weight>
+    indexed_graph<Weight> load_dimacs(const std::string& gr_file_name,
+                                      const std::string& co_file_name = "") {
+        static_assert(std::is_arithmetic<Weight>::value,
+                      "DIMACS weights are numbers.");
+
+        const std::uint64_t max_nodes =
+        std::numeric_limits<std::uint32_t>::max();
+
+        mapped_file gr_file(gr_file_name);
+        const char* problem_line = find_header_line(gr_file.begin(),
+                                                    gr_file.end(),
+                                                    'p');
+        const char* p = problem_line + (problem_line != gr_file.end());
+        const char* token_begin;
+        const char* token_end;
+        std::uint64_t node_count;
+        std::uint64_t arc_count;
+
+        if (p == gr_file.end()
+            || !parse_token(p, gr_file.end(), token_begin, token_end)
+            || !token_equals(token_begin, token_end, "sp")
+            || !parse_unsigned(p, gr_file.end(), node_count)
+            || !parse_unsigned(p, gr_file.end(), arc_count)
+            || !at_line_end(p, gr_file.end())
+            || node_count > max_nodes) {
+            throw std::runtime_error{
+                "Missing or malformed DIMACS problem line."};
+        }
+
+        auto parse_arc = [node_count](const char* line,
+                                      const char* line_end,
+                                      std::vector<dimacs_arc<Weight>>& arcs) {
+            if (at_line_end(line, line_end) || *line == 'c') {
+                return;
+            }
+
+            const char* p = line + 1;
+            std::uint64_t tail;
+            std::uint64_t head;
+            std::uint64_t weight;
+
+            if (*line != 'a'
+                || !parse_unsigned(p, line_end, tail)
+                || !parse_unsigned(p, line_end, head)
+                || !parse_unsigned(p, line_end, weight)
+                || !at_line_end(p, line_end)) {
+                throw std::runtime_error{"Malformed DIMACS arc line."};
+            }
+
+            if (tail == 0 || head == 0
+                || tail > node_count || head > node_count) {
+                throw std::runtime_error{"DIMACS arc node out of range."};
+            }
+
+            arcs.push_back({static_cast<std::uint32_t>(tail - 1),
+                            static_cast<std::uint32_t>(head - 1),
+                            static_cast<Weight>(weight)});
+        };
+
+        std::vector<std::vector<dimacs_arc<Weight>>> chunks =
+        parse_lines_in_parallel<dimacs_arc<Weight>>(
+                                    next_line(problem_line, gr_file.end()),
+                                    gr_file.end(),
+                                    parse_arc);
+
+        std::vector<std::size_t> offsets(node_count + 1, 0);
+        std::size_t parsed_arcs = 0;
+
+        for (const auto& arcs : chunks) {
+            for (const dimacs_arc<Weight>& arc : arcs) {
+                ++offsets[arc.m_tail + 1];
+            }
+
+            parsed_arcs += arcs.size();
+        }
+
+        if (parsed_arcs != arc_count) {
+            throw std::runtime_error{
+                "DIMACS arc count does not match the problem line."};
+        }
+
+        for (std::size_t id = 0; id < node_count; ++id) {
+            offsets[id + 1] += offsets[id];
+        }
+
+        std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+        std::vector<std::uint32_t> heads(parsed_arcs);
+        std::vector<Weight> weights(parsed_arcs);
+
+        for (auto& arcs : chunks) {
+            for (const dimacs_arc<Weight>& arc : arcs) {
+                std::size_t position = next[arc.m_tail]++;
+                heads[position] = arc.m_head;
+                weights[position] = arc.m_weight;
+            }
+
+            std::vector<dimacs_arc<Weight>>().swap(arcs);
+        }
+
+        std::vector<double> xs;
+        std::vector<double> ys;
+
+        if (!co_file_name.empty()) {
+            mapped_file co_file(co_file_name);
+            const char* coordinate_line = find_header_line(co_file.begin(),
+                                                           co_file.end(),
+                                                           'p');
+            p = coordinate_line + (coordinate_line != co_file.end());
+            std::uint64_t coordinate_count;
+
+            if (p == co_file.end()
+                || !parse_token(p, co_file.end(), token_begin, token_end)
+                || !token_equals(token_begin, token_end, "aux")
+                || !parse_token(p, co_file.end(), token_begin, token_end)
+                || !token_equals(token_begin, token_end, "sp")
+                || !parse_token(p, co_file.end(), token_begin, token_end)
+                || !token_equals(token_begin, token_end, "co")
+                || !parse_unsigned(p, co_file.end(), coordinate_count)
+                || !at_line_end(p, co_file.end())) {
+                throw std::runtime_error{
+                    "Missing or malformed DIMACS coordinate problem line."};
+            }
+
+            if (coordinate_count != node_count) {
+                throw std::runtime_error{
+                    "DIMACS coordinate count does not match the graph."};
+            }
+
+            xs.assign(node_count, 0.0);
+            ys.assign(node_count, 0.0);
+
+            // A node's coordinates are written only by the line that claims
+            // it first; a second line for the same node is an error.
+            std::vector<std::atomic<char>> seen(node_count);
+
+            auto parse_coordinates = [&](const char* line,
+                                         const char* line_end,
+                                         std::vector<std::uint32_t>& ids) {
+                if (at_line_end(line, line_end) || *line == 'c') {
+                    return;
+                }
+
+                const char* p = line + 1;
+                std::uint64_t id;
+                std::int64_t x;
+                std::int64_t y;
+
+                if (*line != 'v'
+                    || !parse_unsigned(p, line_end, id)
+                    || !parse_signed(p, line_end, x)
+                    || !parse_signed(p, line_end, y)
+                    || !at_line_end(p, line_end)) {
+                    throw std::runtime_error{
+                        "Malformed DIMACS coordinate line."};
+                }
+
+                if (id == 0 || id > node_count) {
+                    throw std::runtime_error{
+                        "DIMACS coordinate node out of range."};
+                }
+
+                if (seen[id - 1].exchange(1, std::memory_order_relaxed)) {
+                    throw std::runtime_error{
+                        "Duplicate DIMACS coordinate line."};
+                }
+
+                xs[id - 1] = static_cast<double>(x);
+                ys[id - 1] = static_cast<double>(y);
+                ids.push_back(static_cast<std::uint32_t>(id - 1));
+            };
+
+            std::vector<std::vector<std::uint32_t>> id_chunks =
+            parse_lines_in_parallel<std::uint32_t>(
+                                    next_line(coordinate_line, co_file.end()),
+                                    co_file.end(),
+                                    parse_coordinates);
+            std::size_t coordinate_lines = 0;
+
+            for (const auto& ids : id_chunks) {
+                coordinate_lines += ids.size();
+            }
+
+            if (coordinate_lines != node_count) {
+                throw std::runtime_error{
+                    "DIMACS coordinate count does not match the graph."};
+            }
+        }
+
+        return indexed_graph<Weight>(std::move(offsets),
+                                     std::move(heads),
+                                     std::move(weights),
+                                     xs,
+                                     ys);
+    }
+
+    // Loads a MovingAI .map grid as an 8-connected graph. Cells '.', 'G' and
+    // 'S' are passable; the cell in column x and row y is node
+    // y * width + x with coordinates (x, y), blocked cells being nodes
+    // without edges. Straight moves cost 1 and diagonal moves sqrt(2), and a
+    // diagonal move needs both cells it squeezes between to be passable, as
+    // in the MovingAI scenarios.
+    template<typename Weight>
+    indexed_graph<Weight> load_movingai_map(const std::string& map_file_name) {
+        static_assert(std::is_floating_point<Weight>::value,
+                      "Diagonal moves cost sqrt(2).");
+
+        mapped_file map_file(map_file_name);
+        const char* p = map_file.begin();
+        const char* end = map_file.end();
+        const char* token_begin;
+        const char* token_end;
+        std::uint64_t height = 0;
+        std::uint64_t width = 0;
+
+        // The header is "type <name>", "height <rows>", "width <columns>"
+        // and "map" lines.
+        while (true) {
+            if (!parse_token(p, end, token_begin, token_end)) {
+                throw std::runtime_error{"Malformed MovingAI map header."};
+            }
+
+            if (token_equals(token_begin, token_end, "height")) {
+                if (!parse_unsigned(p, end, height)) {
+                    throw std::runtime_error{"Malformed MovingAI map header."};
+                }
+            } else if (token_equals(token_begin, token_end, "width")) {
+                if (!parse_unsigned(p, end, width)) {
+                    throw std::runtime_error{"Malformed MovingAI map header."};
+                }
+            } else if (token_equals(token_begin, token_end, "map")) {
+                p = next_line(p, end);
+                break;
+            }
+
+            p = next_line(p, end);
+        }
+
+        const std::uint64_t max_nodes =
+        std::numeric_limits<std::uint32_t>::max();
+
+        if (width == 0
+            || height == 0
+            || width > max_nodes
+            || height > max_nodes
+            || width * height > max_nodes) {
+            throw std::runtime_error{"Bad MovingAI map size."};
+        }
+
+        std::vector<const char*> rows(height);
+
+        for (std::uint64_t y = 0; y < height; ++y) {
+            const char* row_end = next_line(p, end);
+            std::size_t length = row_end - p;
+
+            if (length > 0 && row_end[-1] == '\n') {
+                --length;
+            }
+
+            if (length < width) {
+                throw std::runtime_error{"MovingAI map row too short."};
+            }
+
+            rows[y] = p;
+            p = row_end;
+        }
+
+        const std::size_t w = static_cast<std::size_t>(width);
+        const std::size_t h = static_cast<std::size_t>(height);
+        const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+        const int dy[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+        const Weight diagonal_weight = std::sqrt(Weight(2));
+
+        auto passable = [&](std::size_t x, std::size_t y) {
+            char cell = rows[y][x];
+            return cell == '.' || cell == 'G' || cell == 'S';
+        };
+
+        // Writes the moves out of cell (x, y), at most 8, and returns their
+        // number.
+        auto moves = [&](std::size_t x,
+                         std::size_t y,
+                         std::uint32_t* heads,
+                         Weight* weights) {
+            std::size_t count = 0;
+
+            if (!passable(x, y)) {
+                return count;
+            }
+
+            for (int d = 0; d < 8; ++d) {
+                if ((dx[d] < 0 && x == 0) || (dx[d] > 0 && x + 1 == w)
+                    || (dy[d] < 0 && y == 0) || (dy[d] > 0 && y + 1 == h)) {
+                    continue;
+                }
+
+                std::size_t nx = x + dx[d];
+                std::size_t ny = y + dy[d];
+                bool diagonal = dx[d] != 0 && dy[d] != 0;
+
+                if (!passable(nx, ny)
+                    || (diagonal && (!passable(nx, y) || !passable(x, ny)))) {
+                    continue;
+                }
+
+                heads[count] = static_cast<std::uint32_t>(ny * w + nx);
+                weights[count] = diagonal ? diagonal_weight : Weight(1);
+                ++count;
+            }
+
+            return count;
+        };
+
+        std::vector<std::size_t> offsets(w * h + 1, 0);
+
+        parallel_for(h, [&](std::size_t y) {
+            std::uint32_t row_heads[8];
+            Weight row_weights[8];
+
+            for (std::size_t x = 0; x < w; ++x) {
+                offsets[y * w + x + 1] = moves(x, y, row_heads, row_weights);
+            }
+        });
+
+        for (std::size_t id = 0; id < w * h; ++id) {
+            offsets[id + 1] += offsets[id];
+        }
+
+        std::vector<std::uint32_t> heads(offsets.back());
+        std::vector<Weight> weights(offsets.back());
+        std::vector<double> xs(w * h);
+        std::vector<double> ys(w * h);
+
+        parallel_for(h, [&](std::size_t y) {
+            for (std::size_t x = 0; x < w; ++x) {
+                std::size_t id = y * w + x;
+                xs[id] = static_cast<double>(x);
+                ys[id] = static_cast<double>(y);
+                moves(x, y, &heads[offsets[id]], &weights[offsets[id]]);
+            }
+        });
+
+        return indexed_graph<Weight>(std::move(offsets),
+                                     std::move(heads),
+                                     std::move(weights),
+                                     xs,
+                                     ys);
+    }
+
+    // One query of a MovingAI .scen file. The start and goal cells are nodes
+    // m_start_y * m_width + m_start_x and m_goal_y * m_width + m_goal_x of
+    // the graph 'load_movingai_map()' builds from 'm_map'.
+    struct movingai_scenario {
+        std::uint32_t m_bucket;
+        std::string   m_map;
+        std::uint32_t m_width;
+        std::uint32_t m_height;
+        std::uint32_t m_start_x;
+        std::uint32_t m_start_y;
+        std::uint32_t m_goal_x;
+        std::uint32_t m_goal_y;
+        double        m_optimal_length;
+    };
+
+    // Loads the scenarios of a MovingAI .scen file in file order.
+    inline std::vector<movingai_scenario>
+    load_movingai_scenarios(const std::string& scen_file_name) {
+        mapped_file scen_file(scen_file_name);
+        const char* begin = scen_file.begin();
+        const char* p = begin;
+        const char* token_begin;
+        const char* token_end;
+
+        if (parse_token(p, scen_file.end(), token_begin, token_end)
+            && token_equals(token_begin, token_end, "version")) {
+            begin = next_line(p, scen_file.end());
+        }
+
+        auto parse_scenario = [](const char* line,
+                                 const char* line_end,
+                                 std::vector<movingai_scenario>& scenarios) {
+            if (at_line_end(line, line_end)) {
+                return;
+            }
+
+            const char* p = line;
+            const char* map_begin;
+            const char* map_end;
+            const char* length_begin;
+            const char* length_end;
+            std::uint64_t fields[7];
+            bool valid = parse_unsigned(p, line_end, fields[0])
+                      && parse_token(p, line_end, map_begin, map_end);
+
+            for (int i = 1; i < 7 && valid; ++i) {
+                valid = parse_unsigned(p, line_end, fields[i])
+                     && fields[i] <= std::numeric_limits<std::uint32_t>::max();
+            }
+
+            // The length is the only fractional field; 'strtod()' needs it
+            // terminated.
+            char length[64];
+            valid = valid
+                 && parse_token(p, line_end, length_begin, length_end)
+                 && at_line_end(p, line_end)
+                 && length_end - length_begin < 64;
+
+            if (valid) {
+                std::memcpy(length, length_begin, length_end - length_begin);
+                length[length_end - length_begin] = '\0';
+            }
+
+            char* parsed_end = nullptr;
+            double optimal_length = valid ? std::strtod(length, &parsed_end)
+                                          : 0.0;
+
+            if (!valid || parsed_end != length + (length_end - length_begin)) {
+                throw std::runtime_error{"Malformed MovingAI scenario line."};
+            }
+
+            if (fields[3] >= fields[1] || fields[5] >= fields[1]
+                || fields[4] >= fields[2] || fields[6] >= fields[2]) {
+                throw std::runtime_error{
+                    "MovingAI scenario cell outside the map."};
+            }
+
+            scenarios.push_back({static_cast<std::uint32_t>(fields[0]),
+                                 std::string(map_begin, map_end),
+                                 static_cast<std::uint32_t>(fields[1]),
+                                 static_cast<std::uint32_t>(fields[2]),
+                                 static_cast<std::uint32_t>(fields[3]),
+                                 static_cast<std::uint32_t>(fields[4]),
+                                 static_cast<std::uint32_t>(fields[5]),
+                                 static_cast<std::uint32_t>(fields[6]),
+                                 optimal_length});
+        };
+
+        std::vector<std::vector<movingai_scenario>> chunks =
+        parse_lines_in_parallel<movingai_scenario>(begin,
+                                                   scen_file.end(),
+                                                   parse_scenario);
+        std::vector<movingai_scenario> scenarios;
+
+        for (auto& chunk : chunks) {
+            for (movingai_scenario& scenario : chunk) {
+                scenarios.push_back(std::move(scenario));
+            }
+        }
+
+        return scenarios;
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_GRAPH_LOADERS_HPP
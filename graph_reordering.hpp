@@ -0,0 +1,193 @@
+#ifndef NET_CODERODDE_PATHFINDING_GRAPH_REORDERING_HPP
+#define NET_CODERODDE_PATHFINDING_GRAPH_REORDERING_HPP
+
+#include "contiguous_graph.hpp"
+#include "metric_heuristics.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Node orders that place nodes close in the graph close in memory. Each
+// function returns a 'new_to_old' permutation for 'contiguous_graph::reorder()':
+// entry i is the current id of the node that should get id i.
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // Breadth-first order, starting a new traversal from the lowest unvisited
+    // id whenever the current one runs out.
+    template<typename Node, typename Weight>
+    std::vector<std::uint32_t>
+    bfs_order(const contiguous_graph<Node, Weight>& graph) {
+        std::vector<std::uint32_t> order;
+        std::vector<char> visited(graph.node_count(), 0);
+
+        order.reserve(graph.node_count());
+
+        for (std::uint32_t start = 0; start < graph.node_count(); ++start) {
+            if (visited[start]) {
+                continue;
+            }
+
+            std::size_t head = order.size();
+            visited[start] = 1;
+            order.push_back(start);
+
+            while (head < order.size()) {
+                std::uint32_t id = order[head++];
+                const std::uint32_t* children = graph.heads(id);
+
+                for (std::size_t i = 0; i < graph.degree(id); ++i) {
+                    if (!visited[children[i]]) {
+                        visited[children[i]] = 1;
+                        order.push_back(children[i]);
+                    }
+                }
+            }
+        }
+
+        return order;
+    }
+
+    // Cuthill-McKee order: breadth-first from a minimum degree node of each
+    // component, visiting the children of a node in increasing degree.
+    // Reversed (the default) it is the reverse Cuthill-McKee order, which
+    // usually gives a smaller bandwidth.
+    template<typename Node, typename Weight>
+    std::vector<std::uint32_t>
+    cuthill_mckee_order(const contiguous_graph<Node, Weight>& graph,
+                        bool reverse = true) {
+        std::vector<std::uint32_t> by_degree(graph.node_count());
+        std::iota(by_degree.begin(), by_degree.end(), 0);
+        std::stable_sort(by_degree.begin(),
+                         by_degree.end(),
+                         [&graph](std::uint32_t a, std::uint32_t b) {
+                             return graph.degree(a) < graph.degree(b);
+                         });
+
+        std::vector<std::uint32_t> order;
+        std::vector<char> visited(graph.node_count(), 0);
+        std::vector<std::uint32_t> children;
+
+        order.reserve(graph.node_count());
+
+        for (std::uint32_t start : by_degree) {
+            if (visited[start]) {
+                continue;
+            }
+
+            std::size_t head = order.size();
+            visited[start] = 1;
+            order.push_back(start);
+
+            while (head < order.size()) {
+                std::uint32_t id = order[head++];
+                const std::uint32_t* heads = graph.heads(id);
+                children.clear();
+
+                for (std::size_t i = 0; i < graph.degree(id); ++i) {
+                    if (!visited[heads[i]]) {
+                        visited[heads[i]] = 1;
+                        children.push_back(heads[i]);
+                    }
+                }
+
+                std::stable_sort(children.begin(),
+                                 children.end(),
+                                 [&graph](std::uint32_t a, std::uint32_t b) {
+                                     return graph.degree(a) < graph.degree(b);
+                                 });
+
+                order.insert(order.end(), children.begin(), children.end());
+            }
+        }
+
+        if (reverse) {
+            std::reverse(order.begin(), order.end());
+        }
+
+        return order;
+    }
+
+    // The position of (x, y) along the Hilbert curve filling a
+    // 65536 x 65536 square.
+    inline std::uint64_t hilbert_index(std::uint32_t x, std::uint32_t y) {
+        const std::uint32_t side = 1u << 16;
+        std::uint64_t index = 0;
+
+        for (std::uint32_t s = side / 2; s > 0; s /= 2) {
+            std::uint32_t rx = (x & s) ? 1 : 0;
+            std::uint32_t ry = (y & s) ? 1 : 0;
+            index += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = side - 1 - x;
+                    y = side - 1 - y;
+                }
+
+                std::swap(x, y);
+            }
+        }
+
+        return index;
+    }
+
+    // Orders the nodes along a Hilbert curve through their coordinates,
+    // read with 'coordinates' as in the metric heuristics.
+    template<typename Node,
+             typename Weight,
+             typename Coordinates = node_coordinates<Node>>
+    std::vector<std::uint32_t>
+    hilbert_order(const contiguous_graph<Node, Weight>& graph,
+                  Coordinates coordinates = Coordinates{}) {
+        std::size_t count = graph.node_count();
+        std::vector<double> xs(count);
+        std::vector<double> ys(count);
+
+        for (std::uint32_t id = 0; id < count; ++id) {
+            xs[id] = coordinates.x(graph.node_at(id));
+            ys[id] = coordinates.y(graph.node_at(id));
+        }
+
+        std::vector<std::uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+
+        if (count == 0) {
+            return order;
+        }
+
+        auto x_range = std::minmax_element(xs.begin(), xs.end());
+        auto y_range = std::minmax_element(ys.begin(), ys.end());
+        double min_x = *x_range.first;
+        double min_y = *y_range.first;
+        double span = std::max(*x_range.second - min_x,
+                               *y_range.second - min_y);
+        double scale = span > 0.0 ? 65535.0 / span : 0.0;
+
+        std::vector<std::uint64_t> indices(count);
+
+        for (std::size_t id = 0; id < count; ++id) {
+            indices[id] = hilbert_index(
+                        static_cast<std::uint32_t>((xs[id] - min_x) * scale),
+                        static_cast<std::uint32_t>((ys[id] - min_y) * scale));
+        }
+
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [&indices](std::uint32_t a, std::uint32_t b) {
+                             return indices[a] < indices[b];
+                         });
+
+        return order;
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_GRAPH_REORDERING_HPP
@@ -1,6 +1,8 @@
 #ifndef NET_CODERODDE_PATHFINDING_HEURISTIC_FUNCTION_HPP
 #define NET_CODERODDE_PATHFINDING_HEURISTIC_FUNCTION_HPP
 
+#include <cstddef>
+
 namespace net {
 namespace coderodde {
 namespace pathfinding {
@@ -10,6 +12,27 @@ namespace pathfinding {
         
     public:
         virtual DistanceType operator()(const Node& target) const = 0;
+        
+        // Writes the estimates of 'nodes[0]', ..., 'nodes[count - 1]' to
+        // 'estimates'. Override it when a batch can be estimated faster than
+        // one node at a time.
+        virtual void estimate_batch(Node* const* nodes,
+                                    std::size_t count,
+                                    DistanceType* estimates) const {
+            for (std::size_t i = 0; i < count; ++i) {
+                estimates[i] = (*this)(*nodes[i]);
+            }
+        }
+        
+        // Like 'estimate_batch()' for nodes stored next to each other, such
+        // as the node ids of an 'external_graph'.
+        virtual void estimate_span(const Node* nodes,
+                                   std::size_t count,
+                                   DistanceType* estimates) const {
+            for (std::size_t i = 0; i < count; ++i) {
+                estimates[i] = (*this)(nodes[i]);
+            }
+        }
     };
     
 } // End of namespace net::coderodde::pathfinding.
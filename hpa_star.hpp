@@ -0,0 +1,675 @@
+#ifndef NET_CODERODDE_PATHFINDING_HPA_STAR_HPP
+#define NET_CODERODDE_PATHFINDING_HPA_STAR_HPP
+
+#include "a_star.hpp"
+#include "dijkstra.hpp"
+#include "heuristic_function.hpp"
+#include "metric_heuristics.hpp"
+#include "parallel_for.hpp"
+#include "path_not_found_exception.hpp"
+#include "weighted_path.hpp"
+#include "weight_function.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    template<typename Node, typename Weight>
+    class hierarchical_grid;
+
+    // A path through the abstract graph of a 'hierarchical_grid'. Holds only
+    // the abstract waypoints (source, cluster entrances, target); the
+    // concrete cell-by-cell path is computed on demand by 'refine()'.
+    template<typename Node, typename Weight>
+    class abstract_path {
+    public:
+        abstract_path(const hierarchical_grid<Node, Weight>* grid,
+                      std::vector<Node*> waypoints,
+                      Weight total_weight)
+        :
+        m_grid{grid},
+        m_waypoints{waypoints},
+        m_total_weight{total_weight}
+        {}
+
+        std::size_t waypoint_count() const {
+            return m_waypoints.size();
+        }
+
+        Node& waypoint_at(std::size_t index) const {
+            return *m_waypoints.at(index);
+        }
+
+        Weight total_weight() const {
+            return m_total_weight;
+        }
+
+        weighted_path<Node, Weight> refine() const {
+            return m_grid->refine(m_waypoints);
+        }
+
+    private:
+        const hierarchical_grid<Node, Weight>* m_grid;
+        std::vector<Node*> m_waypoints;
+        Weight             m_total_weight;
+    };
+
+    // HPA* abstraction over a rectangular grid of nodes, addressed as
+    // grid[y][x]. The grid is split into square clusters of side
+    // 'cluster_size'. For every run of passable cell pairs along a border of
+    // two adjacent clusters one transition (the middle pair of the run) is
+    // chosen; its two cells become abstract nodes. Intra-cluster distances
+    // between the abstract nodes of each cluster are precomputed in parallel,
+    // so the weight function and the child iteration of 'Node' must be safe
+    // to call from several threads at once.
+    //
+    // Connectivity is taken from the nodes themselves (their 'begin()' and
+    // 'end()'), so a cell that stops being traversable must be reported via
+    // 'update_cell()', which rebuilds only the clusters touching that cell.
+    //
+    // The cluster of a node is computed from its 'x()' and 'y()', which must
+    // equal its column and row in the grid.
+    template<typename Node, typename Weight>
+    class hierarchical_grid {
+    public:
+        hierarchical_grid(std::vector<std::vector<Node>>& grid,
+                          std::size_t cluster_size,
+                          const weight_function<Node, Weight>* weight_function)
+        :
+        m_grid{grid},
+        m_cluster_size{cluster_size},
+        m_weight_function{weight_function}
+        {
+            if (cluster_size == 0) {
+                throw std::invalid_argument{"cluster_size must be positive."};
+            }
+
+            m_height = grid.size();
+            m_width  = m_height == 0 ? 0 : grid[0].size();
+
+            m_clusters_x = (m_width  + cluster_size - 1) / cluster_size;
+            m_clusters_y = (m_height + cluster_size - 1) / cluster_size;
+
+            for (std::size_t y = 0; y < m_height; ++y) {
+                if (grid[y].size() != m_width) {
+                    throw std::invalid_argument{"The grid is not rectangular."};
+                }
+            }
+
+            parallel_for(m_height, [this](std::size_t y) {
+                for (std::size_t x = 0; x < m_width; ++x) {
+                    const Node& node = m_grid[y][x];
+
+                    if (m_coordinates.x(node) != static_cast<double>(x)
+                        || m_coordinates.y(node) != static_cast<double>(y)) {
+                        throw std::invalid_argument{
+                            "A node's coordinates differ from its grid cell."};
+                    }
+                }
+            });
+
+            std::size_t count = cluster_count();
+
+            m_east_transitions .resize(count);
+            m_south_transitions.resize(count);
+            m_cluster_edges    .resize(count);
+
+            parallel_for(count, [this](std::size_t cluster) {
+                build_transitions(cluster);
+            });
+
+            parallel_for(count, [this](std::size_t cluster) {
+                build_cluster_edges(cluster);
+            });
+        }
+
+        std::size_t cluster_count() const {
+            return m_clusters_x * m_clusters_y;
+        }
+
+        std::size_t abstract_node_count() const {
+            std::size_t count = 0;
+
+            for (const auto& edges : m_cluster_edges) {
+                count += edges.size();
+            }
+
+            return count;
+        }
+
+        // Must be called after the traversability of grid[y][x] changes.
+        // Rebuilds the borders of the cluster containing the cell and the
+        // abstract edges of that cluster and of its four neighbours.
+        void update_cell(std::size_t x, std::size_t y) {
+            if (x >= m_width || y >= m_height) {
+                throw std::out_of_range{"The cell is outside of the grid."};
+            }
+
+            std::size_t cx = x / m_cluster_size;
+            std::size_t cy = y / m_cluster_size;
+            std::size_t cluster = cluster_id(cx, cy);
+
+            std::vector<std::size_t> affected;
+            affected.push_back(cluster);
+
+            if (cx > 0) {
+                affected.push_back(cluster_id(cx - 1, cy));
+            }
+
+            if (cy > 0) {
+                affected.push_back(cluster_id(cx, cy - 1));
+            }
+
+            if (cx + 1 < m_clusters_x) {
+                affected.push_back(cluster_id(cx + 1, cy));
+            }
+
+            if (cy + 1 < m_clusters_y) {
+                affected.push_back(cluster_id(cx, cy + 1));
+            }
+
+            // The borders of 'cluster' are owned by itself (east, south) and
+            // by its west and north neighbours.
+            build_transitions(cluster);
+
+            if (cx > 0) {
+                build_transitions(cluster_id(cx - 1, cy));
+            }
+
+            if (cy > 0) {
+                build_transitions(cluster_id(cx, cy - 1));
+            }
+
+            parallel_for(affected.size(), [this, &affected](std::size_t i) {
+                build_cluster_edges(affected[i]);
+            });
+        }
+
+        abstract_path<Node, Weight> find_path(Node& source, Node& target) const {
+            zero_heuristic<Node, Weight> h;
+            return find_path(source, target, h);
+        }
+
+        abstract_path<Node, Weight>
+        find_path(Node& source,
+                  Node& target,
+                  const heuristic_function<Node, Weight>& h) const {
+            if (&source == &target) {
+                return abstract_path<Node, Weight>(this,
+                                                   std::vector<Node*>{&source},
+                                                   Weight{});
+            }
+
+            std::size_t source_cluster = cluster_of(&source);
+            std::size_t target_cluster = cluster_of(&target);
+
+            // Temporary edges connecting the source and the target to the
+            // abstract graph:
+            std::unordered_map<Node*, std::vector<abstract_edge>> extra_edges;
+
+            std::vector<Node*> source_entrances = entrances(source_cluster);
+            std::unordered_map<Node*, Weight> source_distances =
+            cluster_search(&source, source_cluster, nullptr, nullptr);
+
+            for (Node* entrance : source_entrances) {
+                auto it = source_distances.find(entrance);
+
+                if (it != source_distances.end() && entrance != &source) {
+                    extra_edges[&source].push_back({entrance, it->second});
+                }
+            }
+
+            if (source_cluster == target_cluster) {
+                auto it = source_distances.find(&target);
+
+                if (it != source_distances.end()) {
+                    extra_edges[&source].push_back({&target, it->second});
+                }
+            }
+
+            for (Node* entrance : entrances(target_cluster)) {
+                if (entrance == &target) {
+                    continue;
+                }
+
+                std::unordered_map<Node*, Weight> distances =
+                cluster_search(entrance, target_cluster, &target, nullptr);
+
+                auto it = distances.find(&target);
+
+                if (it != distances.end()) {
+                    extra_edges[entrance].push_back({&target, it->second});
+                }
+            }
+
+            auto cmp = [](node_holder<Node, Weight> nh1,
+                          node_holder<Node, Weight> nh2) {
+                return nh1.m_f > nh2.m_f;
+            };
+
+            std::priority_queue<node_holder<Node, Weight>,
+                                std::vector<node_holder<Node, Weight>>,
+                                decltype(cmp)> open(cmp);
+
+            std::unordered_set<Node*> closed;
+            std::unordered_map<Node*, Node*> parents;
+            std::unordered_map<Node*, Weight> distances;
+
+            open.push(node_holder<Node, Weight>(&source, Weight{}));
+            parents[&source] = nullptr;
+            distances[&source] = Weight{};
+
+            while (!open.empty()) {
+                Node* current_node = open.top().m_node;
+                open.pop();
+
+                if (current_node == &target) {
+                    std::vector<Node*> waypoints;
+
+                    for (Node* node = current_node; node; node = parents[node]) {
+                        waypoints.push_back(node);
+                    }
+
+                    std::reverse(waypoints.begin(), waypoints.end());
+                    return abstract_path<Node, Weight>(this,
+                                                       waypoints,
+                                                       distances[current_node]);
+                }
+
+                if (closed.find(current_node) != closed.end()) {
+                    continue;
+                }
+
+                closed.insert(current_node);
+
+                auto relax = [&](const abstract_edge& edge) {
+                    if (closed.find(edge.m_head) != closed.end()) {
+                        return;
+                    }
+
+                    Weight tentative_distance = distances[current_node] +
+                                                edge.m_weight;
+
+                    if (distances.find(edge.m_head) == distances.end()
+                        || distances[edge.m_head] > tentative_distance) {
+                        open.push(node_holder<Node, Weight>(
+                                            edge.m_head,
+                                            tentative_distance +
+                                            h(*edge.m_head)));
+                        distances[edge.m_head] = tentative_distance;
+                        parents[edge.m_head] = current_node;
+                    }
+                };
+
+                const auto& cluster_edges =
+                m_cluster_edges[cluster_of(current_node)];
+
+                auto it = cluster_edges.find(current_node);
+
+                if (it != cluster_edges.end()) {
+                    for (const abstract_edge& edge : it->second) {
+                        relax(edge);
+                    }
+                }
+
+                it = extra_edges.find(current_node);
+
+                if (it != extra_edges.end()) {
+                    for (const abstract_edge& edge : it->second) {
+                        relax(edge);
+                    }
+                }
+            }
+
+            throw path_not_found_exception<Node>(source, target);
+        }
+
+    private:
+
+        struct abstract_edge {
+            Node*  m_head;
+            Weight m_weight;
+        };
+
+        // A pair of adjacent cells on the border of two clusters. 'm_first'
+        // lies in the cluster owning the border (the west or north one).
+        struct transition {
+            Node* m_first;
+            Node* m_second;
+            bool  m_forward;
+            bool  m_backward;
+        };
+
+        std::size_t cluster_id(std::size_t cx, std::size_t cy) const {
+            return cy * m_clusters_x + cx;
+        }
+
+        std::size_t cluster_of(const Node* node) const {
+            double x = m_coordinates.x(*node);
+            double y = m_coordinates.y(*node);
+
+            if (!(x >= 0.0 && y >= 0.0 && x < m_width && y < m_height)) {
+                throw std::out_of_range{"The node is not in the grid."};
+            }
+
+            return cluster_id(static_cast<std::size_t>(x) / m_cluster_size,
+                              static_cast<std::size_t>(y) / m_cluster_size);
+        }
+
+        static bool has_child(const Node& node, const Node* child) {
+            for (const Node& child_node : node) {
+                if (&child_node == child) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // Computes the transitions on the east and the south border of
+        // 'cluster'.
+        void build_transitions(std::size_t cluster) {
+            std::size_t cx = cluster % m_clusters_x;
+            std::size_t cy = cluster / m_clusters_x;
+
+            std::size_t x_begin = cx * m_cluster_size;
+            std::size_t y_begin = cy * m_cluster_size;
+            std::size_t x_end = std::min(x_begin + m_cluster_size, m_width);
+            std::size_t y_end = std::min(y_begin + m_cluster_size, m_height);
+
+            m_east_transitions[cluster].clear();
+            m_south_transitions[cluster].clear();
+
+            if (x_end < m_width) {
+                std::vector<transition> border;
+
+                for (std::size_t y = y_begin; y < y_end; ++y) {
+                    border.push_back(make_transition(&m_grid[y][x_end - 1],
+                                                     &m_grid[y][x_end]));
+                }
+
+                select_transitions(border, m_east_transitions[cluster]);
+            }
+
+            if (y_end < m_height) {
+                std::vector<transition> border;
+
+                for (std::size_t x = x_begin; x < x_end; ++x) {
+                    border.push_back(make_transition(&m_grid[y_end - 1][x],
+                                                     &m_grid[y_end][x]));
+                }
+
+                select_transitions(border, m_south_transitions[cluster]);
+            }
+        }
+
+        static transition make_transition(Node* first, Node* second) {
+            return transition{first,
+                              second,
+                              has_child(*first, second),
+                              has_child(*second, first)};
+        }
+
+        // Keeps the middle transition of each maximal run of border positions
+        // that are passable in the same directions. Runs are split on
+        // direction changes, since a one-way position (say, a blocked cell
+        // that still lists its neighbours as children) must not stand in for
+        // a two-way one.
+        static void select_transitions(const std::vector<transition>& border,
+                                       std::vector<transition>& selected) {
+            std::size_t i = 0;
+
+            while (i < border.size()) {
+                if (!border[i].m_forward && !border[i].m_backward) {
+                    ++i;
+                    continue;
+                }
+
+                std::size_t run_begin = i;
+
+                while (i < border.size()
+                       && border[i].m_forward == border[run_begin].m_forward
+                       && border[i].m_backward == border[run_begin].m_backward) {
+                    ++i;
+                }
+
+                selected.push_back(border[run_begin + (i - run_begin) / 2]);
+            }
+        }
+
+        std::vector<Node*> entrances(std::size_t cluster) const {
+            std::size_t cx = cluster % m_clusters_x;
+            std::size_t cy = cluster / m_clusters_x;
+
+            std::vector<Node*> result;
+
+            for (const transition& t : m_east_transitions[cluster]) {
+                result.push_back(t.m_first);
+            }
+
+            for (const transition& t : m_south_transitions[cluster]) {
+                result.push_back(t.m_first);
+            }
+
+            if (cx > 0) {
+                for (const transition& t :
+                     m_east_transitions[cluster_id(cx - 1, cy)]) {
+                    result.push_back(t.m_second);
+                }
+            }
+
+            if (cy > 0) {
+                for (const transition& t :
+                     m_south_transitions[cluster_id(cx, cy - 1)]) {
+                    result.push_back(t.m_second);
+                }
+            }
+
+            std::sort(result.begin(), result.end(), std::less<Node*>());
+            result.erase(std::unique(result.begin(), result.end()),
+                         result.end());
+            return result;
+        }
+
+        void build_cluster_edges(std::size_t cluster) {
+            std::size_t cx = cluster % m_clusters_x;
+            std::size_t cy = cluster / m_clusters_x;
+
+            std::unordered_map<Node*, std::vector<abstract_edge>> edges;
+            std::vector<Node*> cluster_entrances = entrances(cluster);
+
+            for (Node* entrance : cluster_entrances) {
+                std::vector<abstract_edge>& entrance_edges = edges[entrance];
+                std::unordered_map<Node*, Weight> distances =
+                cluster_search(entrance, cluster, nullptr, nullptr);
+
+                for (Node* other : cluster_entrances) {
+                    if (other == entrance) {
+                        continue;
+                    }
+
+                    auto it = distances.find(other);
+
+                    if (it != distances.end()) {
+                        entrance_edges.push_back({other, it->second});
+                    }
+                }
+            }
+
+            const weight_function<Node, Weight>& w = *m_weight_function;
+
+            for (const transition& t : m_east_transitions[cluster]) {
+                if (t.m_forward) {
+                    edges[t.m_first].push_back(
+                                {t.m_second, w(*t.m_first, *t.m_second)});
+                }
+            }
+
+            for (const transition& t : m_south_transitions[cluster]) {
+                if (t.m_forward) {
+                    edges[t.m_first].push_back(
+                                {t.m_second, w(*t.m_first, *t.m_second)});
+                }
+            }
+
+            if (cx > 0) {
+                for (const transition& t :
+                     m_east_transitions[cluster_id(cx - 1, cy)]) {
+                    if (t.m_backward) {
+                        edges[t.m_second].push_back(
+                                {t.m_first, w(*t.m_second, *t.m_first)});
+                    }
+                }
+            }
+
+            if (cy > 0) {
+                for (const transition& t :
+                     m_south_transitions[cluster_id(cx, cy - 1)]) {
+                    if (t.m_backward) {
+                        edges[t.m_second].push_back(
+                                {t.m_first, w(*t.m_second, *t.m_first)});
+                    }
+                }
+            }
+
+            m_cluster_edges[cluster] = std::move(edges);
+        }
+
+        // Dijkstra's algorithm restricted to the cells of 'cluster'. Stops as
+        // soon as 'target' is settled, unless 'target' is null.
+        std::unordered_map<Node*, Weight>
+        cluster_search(Node* source,
+                       std::size_t cluster,
+                       Node* target,
+                       std::unordered_map<Node*, Node*>* parents) const {
+            auto cmp = [](node_holder<Node, Weight> nh1,
+                          node_holder<Node, Weight> nh2) {
+                return nh1.m_f > nh2.m_f;
+            };
+
+            std::priority_queue<node_holder<Node, Weight>,
+                                std::vector<node_holder<Node, Weight>>,
+                                decltype(cmp)> open(cmp);
+
+            std::unordered_set<Node*> closed;
+            std::unordered_map<Node*, Weight> distances;
+            const weight_function<Node, Weight>& w = *m_weight_function;
+
+            open.push(node_holder<Node, Weight>(source, Weight{}));
+            distances[source] = Weight{};
+
+            if (parents) {
+                (*parents)[source] = nullptr;
+            }
+
+            while (!open.empty()) {
+                Node* current_node = open.top().m_node;
+                open.pop();
+
+                if (current_node == target) {
+                    break;
+                }
+
+                if (closed.find(current_node) != closed.end()) {
+                    continue;
+                }
+
+                closed.insert(current_node);
+
+                const Node& expanded_node = *current_node;
+
+                for (Node& child_node : expanded_node) {
+                    if (closed.find(&child_node) != closed.end()
+                        || cluster_of(&child_node) != cluster) {
+                        continue;
+                    }
+
+                    Weight tentative_distance = distances[current_node] +
+                                                w(*current_node, child_node);
+
+                    if (distances.find(&child_node) == distances.end()
+                        || distances[&child_node] > tentative_distance) {
+                        open.push(node_holder<Node, Weight>(
+                                            &child_node,
+                                            tentative_distance));
+                        distances[&child_node] = tentative_distance;
+
+                        if (parents) {
+                            (*parents)[&child_node] = current_node;
+                        }
+                    }
+                }
+            }
+
+            return distances;
+        }
+
+        weighted_path<Node, Weight>
+        refine(const std::vector<Node*>& waypoints) const {
+            std::vector<Node*> path{waypoints.front()};
+            const weight_function<Node, Weight>& w = *m_weight_function;
+
+            for (std::size_t i = 0; i + 1 < waypoints.size(); ++i) {
+                Node* tail = waypoints[i];
+                Node* head = waypoints[i + 1];
+                std::size_t cluster = cluster_of(tail);
+
+                if (cluster != cluster_of(head)) {
+                    // An inter-cluster edge is a single grid move.
+                    path.push_back(head);
+                    continue;
+                }
+
+                std::unordered_map<Node*, Node*> parents;
+                cluster_search(tail, cluster, head, &parents);
+
+                std::vector<Node*> segment;
+
+                for (Node* node = head; node != tail; node = parents.at(node)) {
+                    segment.push_back(node);
+                }
+
+                path.insert(path.end(), segment.rbegin(), segment.rend());
+            }
+
+            Weight total_weight {};
+
+            for (std::size_t i = 0; i + 1 < path.size(); ++i) {
+                total_weight += w(*path[i], *path[i + 1]);
+            }
+
+            return weighted_path<Node, Weight>(path, total_weight);
+        }
+
+        std::vector<std::vector<Node>>& m_grid;
+        std::size_t m_width;
+        std::size_t m_height;
+        std::size_t m_cluster_size;
+        std::size_t m_clusters_x;
+        std::size_t m_clusters_y;
+
+        const weight_function<Node, Weight>* m_weight_function;
+        node_coordinates<Node>               m_coordinates;
+
+        std::vector<std::vector<transition>> m_east_transitions;
+        std::vector<std::vector<transition>> m_south_transitions;
+        std::vector<std::unordered_map<Node*, std::vector<abstract_edge>>>
+        m_cluster_edges;
+
+        friend class abstract_path<Node, Weight>;
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_HPA_STAR_HPP
@@ -0,0 +1,229 @@
+#ifndef NET_CODERODDE_PATHFINDING_INDEXED_GRAPH_HPP
+#define NET_CODERODDE_PATHFINDING_INDEXED_GRAPH_HPP
+
+#include "contiguous_graph.hpp"
+#include "weight_function.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // A node of an 'indexed_graph'. It knows only its id and coordinates;
+    // its children are read from the adjacency arrays of the graph.
+    template<typename Weight>
+    class indexed_node {
+    public:
+        typedef contiguous_graph<indexed_node<Weight>, Weight> graph_type;
+
+        class child_iterator {
+        public:
+            child_iterator(const graph_type* graph, const std::uint32_t* head)
+            :
+            m_graph{graph},
+            m_head{head}
+            {}
+
+            child_iterator& operator++() {
+                ++m_head;
+                return *this;
+            }
+
+            bool operator!=(const child_iterator& other) const {
+                return m_head != other.m_head;
+            }
+
+            indexed_node& operator*() const {
+                return m_graph->node_at(*m_head);
+            }
+
+        private:
+            const graph_type*    m_graph;
+            const std::uint32_t* m_head;
+        };
+
+        indexed_node(const graph_type* graph,
+                     std::uint32_t id,
+                     double x,
+                     double y)
+        :
+        m_graph{graph},
+        m_id{id},
+        m_x{x},
+        m_y{y}
+        {}
+
+        std::uint32_t id() const { return m_id; }
+        double x() const { return m_x; }
+        double y() const { return m_y; }
+
+        bool operator==(const indexed_node& other) const {
+            return m_id == other.m_id;
+        }
+
+        child_iterator begin() const {
+            return child_iterator(m_graph, m_graph->heads(m_id));
+        }
+
+        child_iterator end() const {
+            return child_iterator(m_graph,
+                                  m_graph->heads(m_id) + m_graph->degree(m_id));
+        }
+
+    private:
+        const graph_type* m_graph;
+        std::uint32_t     m_id;
+        double            m_x;
+        double            m_y;
+
+        friend std::ostream& operator<<(std::ostream& out,
+                                        const indexed_node& node) {
+            return out << "{id=" << node.m_id << ", x=" << node.m_x
+                       << ", y=" << node.m_y << "}";
+        }
+    };
+
+    // The graph finds node ids in the nodes, without a hash table.
+    template<typename Weight>
+    struct node_id_traits<indexed_node<Weight>> {
+        static const bool stores_id = true;
+
+        static std::uint32_t id(const indexed_node<Weight>& node) {
+            return node.id();
+        }
+    };
+
+    // Reads edge weights of an 'indexed_graph' for the node-based searches.
+    // Looks up the edge among the tail's edges; of parallel edges the
+    // lightest counts.
+    template<typename Weight>
+    class indexed_weight_function :
+    public virtual weight_function<indexed_node<Weight>, Weight> {
+    public:
+        indexed_weight_function(
+                        const typename indexed_node<Weight>::graph_type* graph)
+        :
+        m_graph{graph}
+        {}
+
+        Weight operator()(const indexed_node<Weight>& tail,
+                          const indexed_node<Weight>& head) const {
+            const std::uint32_t* heads = m_graph->heads(tail.id());
+            const Weight* weights = m_graph->weights(tail.id());
+            std::size_t degree = m_graph->degree(tail.id());
+            bool found = false;
+            Weight best{};
+
+            for (std::size_t i = 0; i < degree; ++i) {
+                if (heads[i] == head.id() && (!found || best > weights[i])) {
+                    best = weights[i];
+                    found = true;
+                }
+            }
+
+            if (!found) {
+                throw std::invalid_argument{"No such edge."};
+            }
+
+            return best;
+        }
+
+    private:
+        const typename indexed_node<Weight>::graph_type* m_graph;
+    };
+
+    // A graph that owns its nodes, built in bulk from adjacency arrays, for
+    // example by the loaders in graph_loaders.hpp. Node i has id i. The
+    // nodes work with every search: 'graph()' with the contiguous_graph
+    // search and 'weights()' with the node-based ones.
+    template<typename Weight>
+    class indexed_graph {
+    public:
+        typedef indexed_node<Weight> node_type;
+
+        // The edges of node 'id' occupy positions [offsets[id],
+        // offsets[id + 1]) of 'heads' and 'weights'. 'xs' and 'ys' hold the
+        // node coordinates and may be empty.
+        indexed_graph(std::vector<std::size_t> offsets,
+                      std::vector<std::uint32_t> heads,
+                      std::vector<Weight> weights,
+                      const std::vector<double>& xs = {},
+                      const std::vector<double>& ys = {})
+        {
+            if (offsets.empty()) {
+                throw std::invalid_argument{"Inconsistent adjacency arrays."};
+            }
+
+            std::size_t node_count = offsets.size() - 1;
+
+            if ((!xs.empty() && xs.size() != node_count)
+                || xs.size() != ys.size()) {
+                throw std::invalid_argument{"Coordinate count mismatch."};
+            }
+
+            // The graph is allocated first so that the nodes can point to it;
+            // the node vector is never resized, so the node addresses the
+            // graph stores stay valid, also when this object is moved.
+            m_graph.reset(new typename node_type::graph_type(
+                                            std::vector<node_type*>(),
+                                            std::vector<std::size_t>(1, 0),
+                                            std::vector<std::uint32_t>(),
+                                            std::vector<Weight>()));
+
+            m_nodes.reserve(node_count);
+            std::vector<node_type*> node_pointers;
+            node_pointers.reserve(node_count);
+
+            for (std::size_t id = 0; id < node_count; ++id) {
+                m_nodes.emplace_back(m_graph.get(),
+                                     static_cast<std::uint32_t>(id),
+                                     xs.empty() ? 0.0 : xs[id],
+                                     ys.empty() ? 0.0 : ys[id]);
+                node_pointers.push_back(&m_nodes.back());
+            }
+
+            *m_graph = typename node_type::graph_type(node_pointers,
+                                                      std::move(offsets),
+                                                      std::move(heads),
+                                                      std::move(weights));
+            m_weight_function.reset(
+                            new indexed_weight_function<Weight>(m_graph.get()));
+        }
+
+        std::size_t node_count() const {
+            return m_nodes.size();
+        }
+
+        std::size_t edge_count() const {
+            return m_graph->edge_count();
+        }
+
+        node_type& node(std::uint32_t id) {
+            return m_nodes.at(id);
+        }
+
+        const typename node_type::graph_type& graph() const {
+            return *m_graph;
+        }
+
+        const weight_function<node_type, Weight>& weights() const {
+            return *m_weight_function;
+        }
+
+    private:
+        std::unique_ptr<typename node_type::graph_type>  m_graph;
+        std::vector<node_type>                           m_nodes;
+        std::unique_ptr<indexed_weight_function<Weight>> m_weight_function;
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_INDEXED_GRAPH_HPP
@@ -1,4 +1,8 @@
 #include "pathfinding.hpp"
+#include "hpa_star.hpp"
+#include "contiguous_search.hpp"
+#include "metric_heuristics.hpp"
+#include "search_trace.hpp"
 #include "child_node_iterator.hpp"
 #include "forward_node_expander.hpp"
 #include "path_not_found_exception.hpp"
@@ -17,44 +21,55 @@ using net::coderodde::pathfinding::weighted_path;
 using net::coderodde::pathfinding::forward_node_expander;
 using net::coderodde::pathfinding::path_not_found_exception;
 using net::coderodde::pathfinding::find_shortest_path;
+using net::coderodde::pathfinding::hierarchical_grid;
+using net::coderodde::pathfinding::abstract_path;
+using net::coderodde::pathfinding::nearest_target_path;
+using net::coderodde::pathfinding::contiguous_graph;
+using net::coderodde::pathfinding::manhattan_heuristic;
+using net::coderodde::pathfinding::trace_recorder;
 
 // This is just a sample graph node type. The only requirement for coupling it
 // with the search algorithms is 'bool operator==(const grid_node& other) const'
-// and 'begin()' + 'end()' for iterating over the child nodes.
+// and const 'begin()' + 'end()' for iterating over the child nodes.
 class grid_node {
 private:
     
     class grid_node_neighbor_iterator : public child_node_iterator<grid_node> {
     private:
-        std::vector<grid_node*>* m_neighbor_vector;
-        std::size_t m_index;
+        const grid_node* m_grid_node;
+        int m_direction;
+        
+        // Moves to the first traversable neighbor at or after m_direction:
+        void skip_blocked_neighbors() {
+            while (m_direction < 4 && !m_grid_node->neighbor(m_direction)) {
+                ++m_direction;
+            }
+        }
         
     public:
-        grid_node_neighbor_iterator(std::vector<grid_node*>* neighbor_vector,
-                                    std::size_t index)
+        grid_node_neighbor_iterator(const grid_node* grid_node, int direction)
         :
-        m_neighbor_vector{neighbor_vector},
-        m_index{index} {}
-        
-        ~grid_node_neighbor_iterator() {
-            delete m_neighbor_vector;
+        m_grid_node{grid_node},
+        m_direction{direction} {
+            skip_blocked_neighbors();
         }
         
         grid_node_neighbor_iterator& operator++() {
-            ++m_index;
+            ++m_direction;
+            skip_blocked_neighbors();
             return *this;
         }
         
-        bool operator==(grid_node_neighbor_iterator& other) const {
-            return m_index == other.m_index;
+        bool operator==(const grid_node_neighbor_iterator& other) const {
+            return m_direction == other.m_direction;
         }
         
-        bool operator!=(grid_node_neighbor_iterator& other) const {
-            return m_index != other.m_index;
+        bool operator!=(const grid_node_neighbor_iterator& other) const {
+            return m_direction != other.m_direction;
         }
         
         grid_node& operator*() {
-            return *m_neighbor_vector->at(m_index);
+            return *m_grid_node->neighbor(m_direction);
         }
     };
     
@@ -67,53 +82,21 @@ public:
     void set_left_neighbor   (grid_node& neighbor);
     void set_right_neighbor  (grid_node& neighbor);
     
-    bool operator==(const grid_node& other) {
+    bool operator==(const grid_node& other) const {
         return m_x == other.m_x && m_y == other.m_y;
     }
     
-    grid_node_neighbor_iterator begin() {
-        std::vector<grid_node*>* neighbor_vector =
-        new std::vector<grid_node*>;
-        
-        if (m_top_neighbor && m_top_neighbor->m_traversable) {
-            neighbor_vector->push_back(m_top_neighbor);
-        }
-        
-        if (m_bottom_neighbor && m_bottom_neighbor->m_traversable) {
-            neighbor_vector->push_back(m_bottom_neighbor);
-        }
-        
-        if (m_left_neighbor && m_left_neighbor->m_traversable) {
-            neighbor_vector->push_back(m_left_neighbor);
-        }
-        
-        if (m_right_neighbor && m_right_neighbor->m_traversable) {
-            neighbor_vector->push_back(m_right_neighbor);
-        }
-        
-        return grid_node_neighbor_iterator(neighbor_vector, 0);
+    int x() const { return m_x; }
+    int y() const { return m_y; }
+    
+    // Iterating the children neither allocates nor modifies the node, so
+    // any number of threads may search the same grid.
+    grid_node_neighbor_iterator begin() const {
+        return grid_node_neighbor_iterator(this, 0);
     }
     
-    grid_node_neighbor_iterator end() {
-        std::size_t neighbor_count = 0;
-        
-        if (m_top_neighbor && m_top_neighbor->m_traversable) {
-            neighbor_count++;
-        }
-        
-        if (m_bottom_neighbor && m_bottom_neighbor->m_traversable) {
-            neighbor_count++;
-        }
-        
-        if (m_left_neighbor && m_left_neighbor->m_traversable) {
-            neighbor_count++;
-        }
-        
-        if (m_right_neighbor && m_right_neighbor->m_traversable) {
-            neighbor_count++;
-        }
-        
-        return grid_node_neighbor_iterator(nullptr, neighbor_count);
+    grid_node_neighbor_iterator end() const {
+        return grid_node_neighbor_iterator(this, 4);
     }
     
     // Heuristic function must know the coordinates:
@@ -129,6 +112,17 @@ public:
     
 private:
     
+    // The top, bottom, left and right neighbor for directions 0 to 3, or
+    // nullptr if there is none or it is not traversable:
+    grid_node* neighbor(int direction) const {
+        grid_node* neighbors[] = { m_top_neighbor,
+                                   m_bottom_neighbor,
+                                   m_left_neighbor,
+                                   m_right_neighbor };
+        grid_node* neighbor = neighbors[direction];
+        return neighbor && neighbor->m_traversable ? neighbor : nullptr;
+    }
+    
     int m_x;
     int m_y;
     
@@ -190,6 +184,21 @@ std::ostream& operator<<(std::ostream& out, const grid_node& gn)
     return out;
 }
 
+// Trace grid nodes by their coordinates so that trace_replay can draw
+// heatmaps:
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+    template<>
+    struct trace_key<grid_node> {
+        std::uint64_t operator()(const grid_node& node) const {
+            return grid_trace_key(node.x(), node.y());
+        }
+    };
+}
+}
+}
+
 // This class will be used as an EDGE WEIGHT:
 class matrix {
 public:
@@ -252,11 +261,11 @@ private:
     
     private:
         std::size_t m_index;
-        std::vector<matrix_node*>* m_matrix_node_pointer_vector;
+        const std::vector<matrix_node*>* m_matrix_node_pointer_vector;
         
     public:
         matrix_node_child_iterator(
-                        std::vector<matrix_node*>& matrix_node_pointer_vector,
+                    const std::vector<matrix_node*>& matrix_node_pointer_vector,
                         std::size_t index)
         : m_matrix_node_pointer_vector{&matrix_node_pointer_vector},
           m_index{index} {}
@@ -266,7 +275,7 @@ private:
             return *this;
         }
         
-        bool operator!=(const matrix_node_child_iterator& other) {
+        bool operator!=(const matrix_node_child_iterator& other) const {
             return m_index != other.m_index;
         }
         
@@ -287,11 +296,11 @@ public:
         m_neighbors.push_back(&neighbor);
     }
     
-    matrix_node_child_iterator begin() {
+    matrix_node_child_iterator begin() const {
         return matrix_node_child_iterator(m_neighbors, 0);
     }
     
-    matrix_node_child_iterator end() {
+    matrix_node_child_iterator end() const {
         return matrix_node_child_iterator(m_neighbors, m_neighbors.size());
     }
     
@@ -329,7 +338,7 @@ class grid_node_weight_function :
 public virtual weight_function<grid_node, int>
 {
 public:
-    int operator()(const grid_node& a, const grid_node& b) {
+    int operator()(const grid_node& a, const grid_node& b) const {
         return 1;
     }
 };
@@ -361,8 +370,11 @@ public:
         return m_map[node];
     }
     
-    matrix operator()(const matrix_node& tail, const matrix_node& head) override {
-        return m_map[tail][head];
+    // Uses at() rather than operator[], which would insert on a miss and
+    // race with concurrent searches:
+    matrix operator()(const matrix_node& tail,
+                      const matrix_node& head) const override {
+        return m_map.at(tail).at(head);
     }
     
 private:
@@ -445,6 +457,91 @@ int main(int argc, const char * argv[]) {
         std::cerr << ex.what() << "\n";
     }
     
+    ////////// TRACE DEMO ///////////
+    // Traces the maze search into the file given as the first argument;
+    // view it with 'trace_replay <file> --grid'.
+    if (argc > 1) {
+        trace_recorder tracer(argv[1]);
+        
+        try {
+            find_shortest_path<grid_node, int>()
+                .from(grid_node_maze[0][0])
+                .to(grid_node_maze[6][5])
+                .with_weights(&grid_node_wf)
+                .traced_by(&tracer)
+                .with_heuristic_function(&grid_node_hf);
+        } catch (path_not_found_exception<grid_node>& ex) {
+            std::cerr << ex.what() << "\n";
+        }
+        
+        std::cout << "Search trace written to " << argv[1] << "\n";
+    }
+    
+    ////////// NEAREST TARGET DEMO ///////////
+    std::vector<grid_node*> maze_exits = { &grid_node_maze[6][5],
+                                           &grid_node_maze[4][0],
+                                           &grid_node_maze[0][4] };
+    
+    try {
+        nearest_target_path<grid_node, int> path
+        = find_shortest_path<grid_node, int>()
+            .from(grid_node_maze[0][0])
+            .to_any_of(maze_exits)
+            .with_weights(&grid_node_wf)
+            .without_heuristic_function();
+        
+        std::cout << path << "\n";
+        std::cout << "Closest exit: " << path.target()
+                  << ", distance: " << path.total_weight() << "\n";
+    } catch (path_not_found_exception<grid_node>& ex) {
+        std::cerr << ex.what() << "\n";
+    }
+    
+    ////////// CONTIGUOUS GRAPH DEMO ///////////
+    std::vector<grid_node*> maze_nodes;
+    
+    for (std::vector<grid_node>& row : grid_node_maze) {
+        for (grid_node& node : row) {
+            maze_nodes.push_back(&node);
+        }
+    }
+    
+    contiguous_graph<grid_node, int> contiguous_maze(maze_nodes, grid_node_wf);
+    manhattan_heuristic<grid_node, int> maze_manhattan(grid_node_maze[6][5]);
+    
+    try {
+        weighted_path<grid_node, int> path =
+        search(contiguous_maze,
+               grid_node_maze[0][0],
+               grid_node_maze[6][5],
+               maze_manhattan);
+        
+        std::cout << path << "\n";
+        std::cout << "Final contiguous maze distance: " << path.total_weight()
+                  << "\n";
+    } catch (path_not_found_exception<grid_node>& ex) {
+        std::cerr << ex.what() << "\n";
+    }
+    
+    ////////// HPA* DEMO ///////////
+    hierarchical_grid<grid_node, int> hierarchical_maze(grid_node_maze,
+                                                        3,
+                                                        &grid_node_wf);
+    
+    try {
+        abstract_path<grid_node, int> abstract =
+        hierarchical_maze.find_path(grid_node_maze[0][0],
+                                    grid_node_maze[6][5],
+                                    grid_node_hf);
+        
+        weighted_path<grid_node, int> path = abstract.refine();
+        std::cout << path << "\n";
+        std::cout << "Final HPA* maze distance: " << path.total_weight()
+                  << " (" << abstract.waypoint_count() << " waypoints)\n";
+    } catch (path_not_found_exception<grid_node>& ex) {
+        std::cerr << ex.what() << "\n";
+    }
+    
     ////////// MATRIX DEMO ///////////
     matrix_node a{1};
     matrix_node b{2};
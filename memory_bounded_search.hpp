@@ -0,0 +1,353 @@
+#ifndef NET_CODERODDE_PATHFINDING_MEMORY_BOUNDED_SEARCH_HPP
+#define NET_CODERODDE_PATHFINDING_MEMORY_BOUNDED_SEARCH_HPP
+
+#include "dijkstra.hpp"
+#include "heuristic_function.hpp"
+#include "search_budget_exceeded_exception.hpp"
+#include "path_not_found_exception.hpp"
+#include "weighted_path.hpp"
+#include "weight_function.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // A path found by 'bounded_search()'. 'is_optimal()' is false if the
+    // beam discarded nodes, in which case a shorter path may exist.
+    template<typename Node, typename Weight>
+    class bounded_path : public weighted_path<Node, Weight> {
+    public:
+        bounded_path(weighted_path<Node, Weight> path,
+                     bool optimal,
+                     std::size_t pruned_nodes)
+        :
+        weighted_path<Node, Weight>{path},
+        m_optimal{optimal},
+        m_pruned_nodes{pruned_nodes}
+        {}
+
+        bool is_optimal() const {
+            return m_optimal;
+        }
+
+        std::size_t pruned_nodes() const {
+            return m_pruned_nodes;
+        }
+
+    private:
+        bool        m_optimal;
+        std::size_t m_pruned_nodes;
+    };
+
+    template<typename Node, typename Weight>
+    struct bounded_search_node {
+        Node*                m_node;
+        bounded_search_node* m_parent;
+        Weight               m_g;
+        Weight               m_f;
+        Weight               m_forgotten_f; // Least f of pruned children.
+        std::size_t          m_depth;
+        std::size_t          m_children;    // Children in memory.
+        bool                 m_in_open;
+    };
+
+    // The default expansion limit of 'bounded_search()': this many
+    // expansions per node that fits into the memory budget, but never more
+    // than 'bounded_search_max_default_expansions' in all.
+    const std::size_t bounded_search_expansions_per_node = 16;
+    const std::size_t bounded_search_max_default_expansions =
+    std::size_t{1} << 22;
+
+    // Simplified memory-bounded A* (SMA*). The search tree never holds more
+    // nodes than fit into 'memory_budget' bytes: when it grows beyond that,
+    // the worst leaf (highest f, then shallowest) is pruned and its f is
+    // backed up into its parent, which returns to the open list with that
+    // value so the subtree is regenerated if it becomes the most promising
+    // one again. With an admissible 'h' the returned path is optimal; if even
+    // the most promising path does not fit, a
+    // 'search_budget_exceeded_exception' is thrown.
+    //
+    // Once anything has been pruned, an unreachable target is never proven
+    // unreachable, as the forgotten subtrees keep being regenerated, so the
+    // search stops with a 'search_budget_exceeded_exception' after
+    // 'expansion_limit' expansions. A zero 'expansion_limit' stands for 16
+    // ('bounded_search_expansions_per_node') expansions per node that fits
+    // into 'memory_budget', at most 2^22
+    // ('bounded_search_max_default_expansions'), so the work per query stays
+    // bounded however large the budget is. Searches that regenerate a lot
+    // under a tight budget give up early with the default and need an
+    // explicit, larger limit.
+    //
+    // A nonzero 'beam_width' additionally caps the open list at that many
+    // nodes by discarding the worst leaves for good. That bounds the work as
+    // well, but the path is then no longer guaranteed to be optimal.
+    template<typename Node, typename Weight>
+    bounded_path<Node, Weight> bounded_search(Node& source,
+                                              Node& target,
+                                              const weight_function<Node, Weight>& w,
+                                              const heuristic_function<Node, Weight>& h,
+                                              std::size_t memory_budget,
+                                              std::size_t beam_width = 0,
+                                              std::size_t expansion_limit = 0) {
+        typedef bounded_search_node<Node, Weight> search_node;
+
+        const Weight infinity = std::numeric_limits<Weight>::has_infinity ?
+                                std::numeric_limits<Weight>::infinity() :
+                                std::numeric_limits<Weight>::max();
+
+        // A node costs itself plus its open list and index entries.
+        const std::size_t node_bytes = sizeof(search_node) + 12 * sizeof(void*);
+        const std::size_t max_nodes = memory_budget / node_bytes;
+
+        if (max_nodes < 2) {
+            throw search_budget_exceeded_exception::memory(memory_budget);
+        }
+
+        if (expansion_limit == 0) {
+            expansion_limit = std::min(max_nodes,
+                                       bounded_search_max_default_expansions
+                                       / bounded_search_expansions_per_node)
+                              * bounded_search_expansions_per_node;
+        }
+
+        auto cmp = [](const search_node* sn1, const search_node* sn2) {
+            if (sn1->m_f < sn2->m_f) return true;
+            if (sn2->m_f < sn1->m_f) return false;
+            if (sn1->m_depth != sn2->m_depth) return sn1->m_depth > sn2->m_depth;
+            return std::less<const search_node*>()(sn1, sn2);
+        };
+
+        std::set<search_node*, decltype(cmp)> open(cmp);
+
+        // Owns every node in memory.
+        struct node_pool {
+            std::unordered_set<search_node*> m_nodes;
+
+            ~node_pool() {
+                for (search_node* node : m_nodes) {
+                    delete node;
+                }
+            }
+        } pool;
+
+        // The node with the least g of each graph node in memory. Children
+        // that are not better than it are not generated.
+        std::unordered_map<Node*, search_node*> index;
+        std::size_t pruned_nodes = 0;
+        std::size_t expansions = 0;
+        bool discarded = false;
+
+        auto create = [&](Node* node,
+                          search_node* parent,
+                          Weight g,
+                          Weight f) {
+            search_node* sn = new search_node{node,
+                                              parent,
+                                              g,
+                                              f,
+                                              infinity,
+                                              parent ? parent->m_depth + 1 : 0,
+                                              0,
+                                              true};
+            pool.m_nodes.insert(sn);
+            open.insert(sn);
+            index[node] = sn;
+
+            if (parent) {
+                ++parent->m_children;
+            }
+        };
+
+        auto reopen = [&](search_node* sn, Weight f) {
+            if (sn->m_in_open) {
+                open.erase(sn);
+            }
+
+            sn->m_f = f;
+            sn->m_in_open = true;
+            open.insert(sn);
+        };
+
+        // Removes 'sn' and, if 'back_up', remembers its f in the parent.
+        // Parents left without children and without anything to regenerate
+        // are dead ends and are removed too.
+        auto prune = [&](search_node* sn, bool back_up) {
+            while (sn->m_parent) {
+                search_node* parent = sn->m_parent;
+
+                if (back_up && sn->m_f < parent->m_forgotten_f) {
+                    parent->m_forgotten_f = sn->m_f;
+                }
+
+                if (sn->m_in_open) {
+                    open.erase(sn);
+                }
+
+                auto it = index.find(sn->m_node);
+
+                if (it != index.end() && it->second == sn) {
+                    index.erase(it);
+                }
+
+                pool.m_nodes.erase(sn);
+                delete sn;
+                ++pruned_nodes;
+                --parent->m_children;
+
+                if (parent->m_forgotten_f < infinity) {
+                    reopen(parent, parent->m_forgotten_f);
+                    return;
+                }
+
+                if (parent->m_children > 0) {
+                    return;
+                }
+
+                sn = parent;
+                back_up = false;
+            }
+        };
+
+        // The worst leaf other than the root and the best open node.
+        auto worst_leaf = [&]() -> search_node* {
+            if (open.empty()) {
+                return nullptr;
+            }
+
+            search_node* best = *open.begin();
+
+            for (auto it = open.rbegin(); it != open.rend(); ++it) {
+                search_node* sn = *it;
+
+                if (sn != best && sn->m_parent && sn->m_children == 0) {
+                    return sn;
+                }
+            }
+
+            return nullptr;
+        };
+
+        std::vector<Node*> children;
+        std::vector<Weight> child_distances;
+        std::vector<Weight> estimates;
+
+        Node* source_pointer = &source;
+        Weight source_estimate{};
+        h.estimate_batch(&source_pointer, 1, &source_estimate);
+        create(&source, nullptr, Weight{}, source_estimate);
+
+        while (!open.empty() && (*open.begin())->m_f < infinity) {
+            search_node* current = *open.begin();
+            open.erase(open.begin());
+            current->m_in_open = false;
+
+            if (*current->m_node == target) {
+                std::vector<Node*> path;
+
+                for (search_node* sn = current; sn; sn = sn->m_parent) {
+                    path.push_back(sn->m_node);
+                }
+
+                std::reverse(path.begin(), path.end());
+                return bounded_path<Node, Weight>(
+                            weighted_path<Node, Weight>(path, current->m_g),
+                            !discarded,
+                            pruned_nodes);
+            }
+
+            if (++expansions > expansion_limit) {
+                throw search_budget_exceeded_exception::expansions(
+                                                            expansion_limit);
+            }
+
+            // Generates the children not in memory already, which on a
+            // repeated expansion are the pruned ones.
+            current->m_forgotten_f = infinity;
+            children.clear();
+            child_distances.clear();
+
+            const Node& expanded_node = *current->m_node;
+
+            for (Node& child_node : expanded_node) {
+                Weight g = current->m_g + w(*current->m_node, child_node);
+                auto it = index.find(&child_node);
+
+                if (it == index.end() || g < it->second->m_g) {
+                    children.push_back(&child_node);
+                    child_distances.push_back(g);
+                }
+            }
+
+            estimates.resize(children.size());
+            h.estimate_batch(children.data(), children.size(), estimates.data());
+
+            for (std::size_t i = 0; i < children.size(); ++i) {
+                create(children[i],
+                       current,
+                       child_distances[i],
+                       std::max(current->m_f, child_distances[i] + estimates[i]));
+            }
+
+            if (current->m_children == 0) {
+                if (!current->m_parent) {
+                    break;
+                }
+
+                prune(current, false);
+            }
+
+            while (pool.m_nodes.size() > max_nodes) {
+                search_node* leaf = worst_leaf();
+
+                if (!leaf) {
+                    throw search_budget_exceeded_exception::memory(memory_budget);
+                }
+
+                prune(leaf, true);
+            }
+
+            while (beam_width > 0 && open.size() > beam_width) {
+                search_node* leaf = worst_leaf();
+
+                if (!leaf) {
+                    break;
+                }
+
+                prune(leaf, false);
+                discarded = true;
+            }
+        }
+
+        throw path_not_found_exception<Node>(source, target);
+    }
+
+    template<typename Node, typename Weight>
+    bounded_path<Node, Weight> bounded_search(Node& source,
+                                              Node& target,
+                                              const weight_function<Node, Weight>& w,
+                                              std::size_t memory_budget,
+                                              std::size_t beam_width = 0,
+                                              std::size_t expansion_limit = 0) {
+        zero_heuristic<Node, Weight> h;
+        return bounded_search(source,
+                              target,
+                              w,
+                              h,
+                              memory_budget,
+                              beam_width,
+                              expansion_limit);
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_MEMORY_BOUNDED_SEARCH_HPP
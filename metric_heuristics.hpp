@@ -0,0 +1,525 @@
+#ifndef NET_CODERODDE_PATHFINDING_METRIC_HEURISTICS_HPP
+#define NET_CODERODDE_PATHFINDING_METRIC_HEURISTICS_HPP
+
+#include "cpu_features.hpp"
+#include "heuristic_function.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // Default coordinate accessor: reads 'node.x()' and 'node.y()'.
+    template<typename Node>
+    struct node_coordinates {
+        double x(const Node& node) const {
+            return static_cast<double>(node.x());
+        }
+
+        double y(const Node& node) const {
+            return static_cast<double>(node.y());
+        }
+    };
+
+    // Base of the built-in heuristics that estimate the distance between
+    // the coordinates of a node and those of the target. 'estimate_batch()'
+    // and 'estimate_span()' read the coordinates of up to 'batch_size'
+    // nodes into two arrays and hand them to 'distances()', which the
+    // metrics implement with vector instructions where the CPU has them.
+    // The distance is multiplied by
+    // 'scale', which must not exceed the smallest cost per unit of distance
+    // for the heuristic to stay admissible.
+    template<typename Node, typename Weight, typename Coordinates>
+    class coordinate_heuristic :
+    public virtual heuristic_function<Node, Weight> {
+
+    public:
+        coordinate_heuristic(const Node& target,
+                             double scale,
+                             Coordinates coordinates)
+        :
+        m_coordinates{coordinates},
+        m_target_x{coordinates.x(target)},
+        m_target_y{coordinates.y(target)},
+        m_scale{scale}
+        {}
+
+        Weight operator()(const Node& node) const {
+            double x = m_coordinates.x(node);
+            double y = m_coordinates.y(node);
+            double distance;
+            distances(&x, &y, 1, &distance);
+            return static_cast<Weight>(distance * m_scale);
+        }
+
+        void estimate_batch(Node* const* nodes,
+                            std::size_t count,
+                            Weight* estimates) const {
+            estimate_each(count, estimates, [nodes](std::size_t i) {
+                return nodes[i];
+            });
+        }
+
+        void estimate_span(const Node* nodes,
+                           std::size_t count,
+                           Weight* estimates) const {
+            estimate_each(count, estimates, [nodes](std::size_t i) {
+                return nodes + i;
+            });
+        }
+
+    protected:
+        static const std::size_t batch_size = 64;
+
+        // Writes the unscaled distances from (xs[i], ys[i]) to the target
+        // into 'result'.
+        virtual void distances(const double* xs,
+                               const double* ys,
+                               std::size_t count,
+                               double* result) const = 0;
+
+        Coordinates m_coordinates;
+        double      m_target_x;
+        double      m_target_y;
+        double      m_scale;
+
+    private:
+        // Estimates the nodes 'node_at(0)', ..., 'node_at(count - 1)'.
+        template<typename NodeAt>
+        void estimate_each(std::size_t count,
+                           Weight* estimates,
+                           NodeAt node_at) const {
+            double xs[batch_size];
+            double ys[batch_size];
+            double result[batch_size];
+
+            for (std::size_t begin = 0; begin < count; begin += batch_size) {
+                std::size_t length = std::min(batch_size, count - begin);
+
+                for (std::size_t i = 0; i < length; ++i) {
+                    xs[i] = m_coordinates.x(*node_at(begin + i));
+                    ys[i] = m_coordinates.y(*node_at(begin + i));
+                }
+
+                distances(xs, ys, length, result);
+
+                for (std::size_t i = 0; i < length; ++i) {
+                    estimates[begin + i] =
+                    static_cast<Weight>(result[i] * m_scale);
+                }
+            }
+        }
+    };
+
+    template<typename Node, typename Weight, typename Coordinates>
+    const std::size_t
+    coordinate_heuristic<Node, Weight, Coordinates>::batch_size;
+
+    inline void manhattan_distances_scalar(const double* xs,
+                                           const double* ys,
+                                           std::size_t count,
+                                           double target_x,
+                                           double target_y,
+                                           double* result) {
+        for (std::size_t i = 0; i < count; ++i) {
+            result[i] = std::abs(xs[i] - target_x) + std::abs(ys[i] - target_y);
+        }
+    }
+
+    inline void octile_distances_scalar(const double* xs,
+                                        const double* ys,
+                                        std::size_t count,
+                                        double target_x,
+                                        double target_y,
+                                        double* result) {
+        const double diagonal_extra = std::sqrt(2.0) - 1.0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            double dx = std::abs(xs[i] - target_x);
+            double dy = std::abs(ys[i] - target_y);
+            result[i] = std::max(dx, dy) + diagonal_extra * std::min(dx, dy);
+        }
+    }
+
+    inline void euclidean_distances_scalar(const double* xs,
+                                           const double* ys,
+                                           std::size_t count,
+                                           double target_x,
+                                           double target_y,
+                                           double* result) {
+        for (std::size_t i = 0; i < count; ++i) {
+            double dx = xs[i] - target_x;
+            double dy = ys[i] - target_y;
+            result[i] = std::sqrt(dx * dx + dy * dy);
+        }
+    }
+
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+
+    __attribute__((target("avx2")))
+    inline void manhattan_distances_avx2(const double* xs,
+                                         const double* ys,
+                                         std::size_t count,
+                                         double target_x,
+                                         double target_y,
+                                         double* result) {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        const __m256d tx = _mm256_set1_pd(target_x);
+        const __m256d ty = _mm256_set1_pd(target_y);
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_andnot_pd(sign,
+                                          _mm256_sub_pd(_mm256_loadu_pd(xs + i),
+                                                        tx));
+            __m256d dy = _mm256_andnot_pd(sign,
+                                          _mm256_sub_pd(_mm256_loadu_pd(ys + i),
+                                                        ty));
+            _mm256_storeu_pd(result + i, _mm256_add_pd(dx, dy));
+        }
+
+        manhattan_distances_scalar(xs + i,
+                                   ys + i,
+                                   count - i,
+                                   target_x,
+                                   target_y,
+                                   result + i);
+    }
+
+    __attribute__((target("avx2")))
+    inline void octile_distances_avx2(const double* xs,
+                                      const double* ys,
+                                      std::size_t count,
+                                      double target_x,
+                                      double target_y,
+                                      double* result) {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        const __m256d tx = _mm256_set1_pd(target_x);
+        const __m256d ty = _mm256_set1_pd(target_y);
+        const __m256d diagonal_extra = _mm256_set1_pd(std::sqrt(2.0) - 1.0);
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_andnot_pd(sign,
+                                          _mm256_sub_pd(_mm256_loadu_pd(xs + i),
+                                                        tx));
+            __m256d dy = _mm256_andnot_pd(sign,
+                                          _mm256_sub_pd(_mm256_loadu_pd(ys + i),
+                                                        ty));
+            __m256d longer  = _mm256_max_pd(dx, dy);
+            __m256d shorter = _mm256_min_pd(dx, dy);
+            _mm256_storeu_pd(result + i,
+                             _mm256_add_pd(longer,
+                                           _mm256_mul_pd(diagonal_extra,
+                                                         shorter)));
+        }
+
+        octile_distances_scalar(xs + i,
+                                ys + i,
+                                count - i,
+                                target_x,
+                                target_y,
+                                result + i);
+    }
+
+    __attribute__((target("avx2")))
+    inline void euclidean_distances_avx2(const double* xs,
+                                         const double* ys,
+                                         std::size_t count,
+                                         double target_x,
+                                         double target_y,
+                                         double* result) {
+        const __m256d tx = _mm256_set1_pd(target_x);
+        const __m256d ty = _mm256_set1_pd(target_y);
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), tx);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), ty);
+            __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx),
+                                            _mm256_mul_pd(dy, dy));
+            _mm256_storeu_pd(result + i, _mm256_sqrt_pd(squared));
+        }
+
+        euclidean_distances_scalar(xs + i,
+                                   ys + i,
+                                   count - i,
+                                   target_x,
+                                   target_y,
+                                   result + i);
+    }
+
+    // Squared distances between 3D points and a fixed point.
+    __attribute__((target("avx2")))
+    inline void squared_chords_avx2(const double* xs,
+                                    const double* ys,
+                                    const double* zs,
+                                    std::size_t count,
+                                    double target_x,
+                                    double target_y,
+                                    double target_z,
+                                    double* result) {
+        const __m256d tx = _mm256_set1_pd(target_x);
+        const __m256d ty = _mm256_set1_pd(target_y);
+        const __m256d tz = _mm256_set1_pd(target_z);
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), tx);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), ty);
+            __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(zs + i), tz);
+            __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx),
+                                            _mm256_mul_pd(dy, dy));
+            _mm256_storeu_pd(result + i,
+                             _mm256_add_pd(squared, _mm256_mul_pd(dz, dz)));
+        }
+
+        for (; i < count; ++i) {
+            double dx = xs[i] - target_x;
+            double dy = ys[i] - target_y;
+            double dz = zs[i] - target_z;
+            result[i] = dx * dx + dy * dy + dz * dz;
+        }
+    }
+
+#endif // NET_CODERODDE_PATHFINDING_X86_SIMD
+
+    template<typename Node,
+             typename Weight,
+             typename Coordinates = node_coordinates<Node>>
+    class manhattan_heuristic :
+    public coordinate_heuristic<Node, Weight, Coordinates> {
+
+    public:
+        manhattan_heuristic(const Node& target,
+                            double scale = 1.0,
+                            Coordinates coordinates = Coordinates{})
+        :
+        coordinate_heuristic<Node, Weight, Coordinates>{target,
+                                                        scale,
+                                                        coordinates}
+        {}
+
+    protected:
+        void distances(const double* xs,
+                       const double* ys,
+                       std::size_t count,
+                       double* result) const {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+            if (supported_simd_level() != simd_level::scalar) {
+                manhattan_distances_avx2(xs,
+                                         ys,
+                                         count,
+                                         this->m_target_x,
+                                         this->m_target_y,
+                                         result);
+                return;
+            }
+#endif
+            manhattan_distances_scalar(xs,
+                                       ys,
+                                       count,
+                                       this->m_target_x,
+                                       this->m_target_y,
+                                       result);
+        }
+    };
+
+    // For 8-connected grids where a diagonal move costs sqrt(2).
+    template<typename Node,
+             typename Weight,
+             typename Coordinates = node_coordinates<Node>>
+    class octile_heuristic :
+    public coordinate_heuristic<Node, Weight, Coordinates> {
+
+    public:
+        octile_heuristic(const Node& target,
+                         double scale = 1.0,
+                         Coordinates coordinates = Coordinates{})
+        :
+        coordinate_heuristic<Node, Weight, Coordinates>{target,
+                                                        scale,
+                                                        coordinates}
+        {}
+
+    protected:
+        void distances(const double* xs,
+                       const double* ys,
+                       std::size_t count,
+                       double* result) const {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+            if (supported_simd_level() != simd_level::scalar) {
+                octile_distances_avx2(xs,
+                                      ys,
+                                      count,
+                                      this->m_target_x,
+                                      this->m_target_y,
+                                      result);
+                return;
+            }
+#endif
+            octile_distances_scalar(xs,
+                                    ys,
+                                    count,
+                                    this->m_target_x,
+                                    this->m_target_y,
+                                    result);
+        }
+    };
+
+    template<typename Node,
+             typename Weight,
+             typename Coordinates = node_coordinates<Node>>
+    class euclidean_heuristic :
+    public coordinate_heuristic<Node, Weight, Coordinates> {
+
+    public:
+        euclidean_heuristic(const Node& target,
+                            double scale = 1.0,
+                            Coordinates coordinates = Coordinates{})
+        :
+        coordinate_heuristic<Node, Weight, Coordinates>{target,
+                                                        scale,
+                                                        coordinates}
+        {}
+
+    protected:
+        void distances(const double* xs,
+                       const double* ys,
+                       std::size_t count,
+                       double* result) const {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+            if (supported_simd_level() != simd_level::scalar) {
+                euclidean_distances_avx2(xs,
+                                         ys,
+                                         count,
+                                         this->m_target_x,
+                                         this->m_target_y,
+                                         result);
+                return;
+            }
+#endif
+            euclidean_distances_scalar(xs,
+                                       ys,
+                                       count,
+                                       this->m_target_x,
+                                       this->m_target_y,
+                                       result);
+        }
+    };
+
+    // Great-circle distance on a sphere of radius 'radius'; x is the
+    // longitude and y the latitude, both in degrees. Each point is mapped to
+    // a unit vector, the chord lengths to the target are computed with
+    // vector instructions, and each chord c is turned into the arc length
+    // 2 * radius * asin(c / 2).
+    template<typename Node,
+             typename Weight,
+             typename Coordinates = node_coordinates<Node>>
+    class great_circle_heuristic :
+    public coordinate_heuristic<Node, Weight, Coordinates> {
+
+    public:
+        great_circle_heuristic(const Node& target,
+                               double radius = 6371000.0,
+                               double scale = 1.0,
+                               Coordinates coordinates = Coordinates{})
+        :
+        coordinate_heuristic<Node, Weight, Coordinates>{target,
+                                                        scale,
+                                                        coordinates},
+        m_radius{radius}
+        {
+            to_unit_vector(this->m_target_x,
+                           this->m_target_y,
+                           m_target_unit_x,
+                           m_target_unit_y,
+                           m_target_unit_z);
+        }
+
+    protected:
+        void distances(const double* xs,
+                       const double* ys,
+                       std::size_t count,
+                       double* result) const {
+            const std::size_t batch_size =
+            coordinate_heuristic<Node, Weight, Coordinates>::batch_size;
+
+            double unit_xs[batch_size];
+            double unit_ys[batch_size];
+            double unit_zs[batch_size];
+
+            for (std::size_t begin = 0; begin < count; begin += batch_size) {
+                std::size_t length = std::min(batch_size, count - begin);
+
+                for (std::size_t i = 0; i < length; ++i) {
+                    to_unit_vector(xs[begin + i],
+                                   ys[begin + i],
+                                   unit_xs[i],
+                                   unit_ys[i],
+                                   unit_zs[i]);
+                }
+
+                squared_chords(unit_xs, unit_ys, unit_zs, length, result + begin);
+
+                for (std::size_t i = 0; i < length; ++i) {
+                    double half_chord = std::sqrt(result[begin + i]) / 2.0;
+                    result[begin + i] =
+                    2.0 * m_radius * std::asin(std::min(1.0, half_chord));
+                }
+            }
+        }
+
+    private:
+        static void to_unit_vector(double longitude,
+                                   double latitude,
+                                   double& x,
+                                   double& y,
+                                   double& z) {
+            const double degrees_to_radians = std::acos(-1.0) / 180.0;
+            double lambda = longitude * degrees_to_radians;
+            double phi = latitude * degrees_to_radians;
+            x = std::cos(phi) * std::cos(lambda);
+            y = std::cos(phi) * std::sin(lambda);
+            z = std::sin(phi);
+        }
+
+        void squared_chords(const double* xs,
+                            const double* ys,
+                            const double* zs,
+                            std::size_t count,
+                            double* result) const {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+            if (supported_simd_level() != simd_level::scalar) {
+                squared_chords_avx2(xs,
+                                    ys,
+                                    zs,
+                                    count,
+                                    m_target_unit_x,
+                                    m_target_unit_y,
+                                    m_target_unit_z,
+                                    result);
+                return;
+            }
+#endif
+            for (std::size_t i = 0; i < count; ++i) {
+                double dx = xs[i] - m_target_unit_x;
+                double dy = ys[i] - m_target_unit_y;
+                double dz = zs[i] - m_target_unit_z;
+                result[i] = dx * dx + dy * dy + dz * dz;
+            }
+        }
+
+        double m_radius;
+        double m_target_unit_x;
+        double m_target_unit_y;
+        double m_target_unit_z;
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_METRIC_HEURISTICS_HPP
@@ -0,0 +1,119 @@
+#ifndef NET_CODERODDE_PATHFINDING_NEAREST_TARGET_HPP
+#define NET_CODERODDE_PATHFINDING_NEAREST_TARGET_HPP
+
+#include "a_star.hpp"
+#include "dijkstra.hpp"
+#include "heuristic_function.hpp"
+#include "path_not_found_exception.hpp"
+#include "weighted_path.hpp"
+#include "weight_function.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+    
+    // A shortest path to the closest node of a target set. 'target()' is the
+    // target that was reached.
+    template<typename Node, typename Weight>
+    class nearest_target_path : public weighted_path<Node, Weight> {
+    public:
+        nearest_target_path(Node& target, weighted_path<Node, Weight> path)
+        :
+        weighted_path<Node, Weight>{path},
+        m_target{&target}
+        {}
+        
+        Node& target() const {
+            return *m_target;
+        }
+        
+    private:
+        Node* m_target;
+    };
+    
+    // An admissible heuristic for a target set: the minimum of admissible
+    // per-target heuristics. Each evaluation costs one call per target, so for
+    // large target sets the plain multi-target Dijkstra search (no heuristic)
+    // is usually faster.
+    template<typename Node, typename DistanceType>
+    class min_heuristic_function :
+    public virtual heuristic_function<Node, DistanceType> {
+        
+    public:
+        min_heuristic_function(
+            std::vector<heuristic_function<Node, DistanceType>*> heuristics)
+        :
+        m_heuristics{heuristics}
+        {}
+        
+        DistanceType operator()(const Node& node) const {
+            DistanceType best{};
+            bool first = true;
+            
+            for (heuristic_function<Node, DistanceType>* h : m_heuristics) {
+                DistanceType estimate = (*h)(node);
+                
+                if (first || best > estimate) {
+                    best = estimate;
+                    first = false;
+                }
+            }
+            
+            return best;
+        }
+        
+    private:
+        std::vector<heuristic_function<Node, DistanceType>*> m_heuristics;
+    };
+    
+    // Searches for a shortest path from 'source' to the closest node in
+    // 'targets'. The targets are kept in a hash set, and the search stops at
+    // the first target removed from the open list. 'h' must be admissible
+    // with respect to every target.
+    template<typename Node, typename Weight>
+    nearest_target_path<Node, Weight>
+    search(Node& source,
+           const std::vector<Node*>& targets,
+           const weight_function<Node, Weight>& w,
+           const heuristic_function<Node, Weight>& h) {
+        std::unordered_set<Node*> goals(targets.begin(), targets.end());
+        std::unordered_map<Node*, Node*> parents;
+        
+        Node* reached = nullptr;
+        
+        if (!goals.empty()) {
+            reached = search_until(source,
+                                   [&goals](Node& node) {
+                                       return goals.find(&node) != goals.end();
+                                   },
+                                   w,
+                                   h,
+                                   parents);
+        }
+        
+        if (!reached) {
+            throw path_not_found_exception<Node>(source);
+        }
+        
+        return nearest_target_path<Node, Weight>(
+                                        **goals.find(reached),
+                                        traceback_path(*reached, parents, w));
+    }
+    
+    template<typename Node, typename Weight>
+    nearest_target_path<Node, Weight>
+    search(Node& source,
+           const std::vector<Node*>& targets,
+           const weight_function<Node, Weight>& w) {
+        zero_heuristic<Node, Weight> h;
+        return search(source, targets, w, h);
+    }
+    
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_NEAREST_TARGET_HPP
@@ -0,0 +1,76 @@
+#ifndef NET_CODERODDE_PATHFINDING_PARALLEL_FOR_HPP
+#define NET_CODERODDE_PATHFINDING_PARALLEL_FOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // Calls 'body(i)' for every i in [0, count) using a pool of worker
+    // threads that pull indices from a shared counter. The first exception
+    // thrown by any 'body' call is rethrown in the calling thread once all
+    // workers have stopped.
+    template<typename Body>
+    void parallel_for(std::size_t count, Body body) {
+        std::size_t thread_count =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+        thread_count = std::min(thread_count, count);
+
+        if (thread_count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                body(i);
+            }
+
+            return;
+        }
+
+        std::atomic<std::size_t> next_index{0};
+        std::exception_ptr first_exception;
+        std::mutex exception_mutex;
+
+        auto worker = [&]() {
+            std::size_t i;
+
+            while ((i = next_index.fetch_add(1)) < count) {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(exception_mutex);
+
+                    if (!first_exception) {
+                        first_exception = std::current_exception();
+                    }
+
+                    next_index.store(count);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        for (std::size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back(worker);
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        if (first_exception) {
+            std::rethrow_exception(first_exception);
+        }
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_PARALLEL_FOR_HPP
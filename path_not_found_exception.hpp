@@ -19,10 +19,25 @@ namespace pathfinding {
         m_target{&target}
         {}
         
+        // Used when none of a set of targets is reachable.
+        path_not_found_exception(const Node& source)
+        :
+        std::logic_error{""},
+        m_source{&source},
+        m_target{nullptr}
+        {}
+        
         const char* what() {
             std::stringstream ss;
-            ss << "A path from source {" << *m_source << "} to target {"
-               << *m_target << "} not found.";
+            
+            if (m_target) {
+                ss << "A path from source {" << *m_source << "} to target {"
+                   << *m_target << "} not found.";
+            } else {
+                ss << "A path from source {" << *m_source
+                   << "} to any of the targets not found.";
+            }
+            
             return ss.str().c_str();
         }
         
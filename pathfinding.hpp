@@ -3,7 +3,11 @@
 
 #include "a_star.hpp"
 #include "dijkstra.hpp"
+#include "distance_oracle.hpp"
 #include "heuristic_function.hpp"
+#include "memory_bounded_search.hpp"
+#include "nearest_target.hpp"
+#include "search_trace.hpp"
 #include "weight_function.hpp"
 #include "weighted_path.hpp"
 
@@ -11,66 +15,231 @@ namespace net {
 namespace coderodde {
 namespace pathfinding {
     
+    template<typename Node, typename Weight>
+    class bounded_heuristic_function_selector {
+    public:
+        bounded_heuristic_function_selector(
+                                Node& source,
+                                Node& target,
+                                const weight_function<Node, Weight>* weight_function,
+                                std::size_t memory_budget)
+        :
+        m_source{&source},
+        m_target{&target},
+        m_weight_function{weight_function},
+        m_memory_budget{memory_budget},
+        m_beam_width{0},
+        m_expansion_limit{0} {}
+        
+        // Keeps at most 'beam_width' nodes in the open list. The result may
+        // then be suboptimal.
+        bounded_heuristic_function_selector& with_beam_width(
+                                                    std::size_t beam_width) {
+            m_beam_width = beam_width;
+            return *this;
+        }
+        
+        // Gives up after 'expansion_limit' expansions, which is how a search
+        // that had to prune stops on an unreachable target. Without it the
+        // limit is 16 expansions per node that fits into the budget, at most
+        // 2^22; see 'bounded_search()'.
+        bounded_heuristic_function_selector& with_expansion_limit(
+                                                std::size_t expansion_limit) {
+            m_expansion_limit = expansion_limit;
+            return *this;
+        }
+        
+        bounded_path<Node, Weight> without_heuristic_function() {
+            return bounded_search(*m_source,
+                                  *m_target,
+                                  *m_weight_function,
+                                  m_memory_budget,
+                                  m_beam_width,
+                                  m_expansion_limit);
+        }
+        
+        bounded_path<Node, Weight>
+        with_heuristic_function(
+                const heuristic_function<Node, Weight>* heuristic_function) {
+            return bounded_search(*m_source,
+                                  *m_target,
+                                  *m_weight_function,
+                                  *heuristic_function,
+                                  m_memory_budget,
+                                  m_beam_width,
+                                  m_expansion_limit);
+        }
+        
+    private:
+        Node* m_source;
+        Node* m_target;
+        const weight_function<Node, Weight>* m_weight_function;
+        std::size_t m_memory_budget;
+        std::size_t m_beam_width;
+        std::size_t m_expansion_limit;
+    };
+    
     template<typename Node, typename Weight>
     class heuristic_function_selector {
     public:
         heuristic_function_selector(
                                 Node& source,
                                 Node& target,
-                                weight_function<Node, Weight>* weight_function)
+                                const weight_function<Node, Weight>* weight_function)
         :
-        m_source{source},
-        m_target{target},
-        m_weight_function{weight_function} {}
+        m_source{&source},
+        m_target{&target},
+        m_weight_function{weight_function},
+        m_tracer{nullptr},
+        m_memory_budget{0} {}
+        
+        // Records the search to 'tracer'.
+        heuristic_function_selector& traced_by(trace_recorder* tracer) {
+            m_tracer = tracer;
+            return *this;
+        }
+        
+        // Aborts the search with a 'search_budget_exceeded_exception' once
+        // its state exceeds about 'bytes' bytes.
+        heuristic_function_selector& within_memory_budget(std::size_t bytes) {
+            m_memory_budget = bytes;
+            return *this;
+        }
+        
+        // Switches to the memory-bounded search, which stays within 'bytes'
+        // bytes by forgetting and later regenerating parts of the search.
+        bounded_heuristic_function_selector<Node, Weight>
+        memory_bounded(std::size_t bytes) {
+            return bounded_heuristic_function_selector<Node, Weight>(
+                                                            *m_source,
+                                                            *m_target,
+                                                            m_weight_function,
+                                                            bytes);
+        }
         
         weighted_path<Node, Weight> without_heuristic_function() {
-            return search(m_source, m_target, *m_weight_function);
+            return search(*m_source,
+                          *m_target,
+                          *m_weight_function,
+                          m_tracer,
+                          m_memory_budget);
         }
         
         weighted_path<Node, Weight>
         with_heuristic_function(
-                        heuristic_function<Node, Weight>* heuristic_function) {
-            return search(m_source,
-                          m_target,
+                const heuristic_function<Node, Weight>* heuristic_function) {
+            return search(*m_source,
+                          *m_target,
                           *m_weight_function,
-                          *heuristic_function);
+                          *heuristic_function,
+                          m_tracer,
+                          m_memory_budget);
         }
         
     private:
-        Node m_source;
-        Node m_target;
-        weight_function<Node, Weight>* m_weight_function;
+        Node* m_source;
+        Node* m_target;
+        const weight_function<Node, Weight>* m_weight_function;
+        trace_recorder* m_tracer;
+        std::size_t m_memory_budget;
     };
     
     template<typename Node, typename Weight>
     class weight_function_selector {
     public:
         weight_function_selector(Node& source, Node& target) :
-        m_source{source},
-        m_target{target} {}
+        m_source{&source},
+        m_target{&target} {}
         
         heuristic_function_selector<Node, Weight>
-        with_weights(weight_function<Node, Weight>* wf) {
-            return heuristic_function_selector<Node, Weight>(m_source,
-                                                             m_target,
+        with_weights(const weight_function<Node, Weight>* wf) {
+            return heuristic_function_selector<Node, Weight>(*m_source,
+                                                             *m_target,
                                                              wf);
         }
         
+        // Reads the path from precomputed all-pairs distances instead of
+        // searching.
+        weighted_path<Node, Weight>
+        with_oracle(const distance_oracle<Node, Weight>* oracle) {
+            return oracle->path(*m_source, *m_target);
+        }
+        
+    private:
+        Node* m_source;
+        Node* m_target;
+    };
+    
+    template<typename Node, typename Weight>
+    class target_set_heuristic_function_selector {
+    public:
+        target_set_heuristic_function_selector(
+                                Node& source,
+                                const std::vector<Node*>& targets,
+                                const weight_function<Node, Weight>* weight_function)
+        :
+        m_source{&source},
+        m_targets{targets},
+        m_weight_function{weight_function} {}
+        
+        nearest_target_path<Node, Weight> without_heuristic_function() {
+            return search(*m_source, m_targets, *m_weight_function);
+        }
+        
+        nearest_target_path<Node, Weight>
+        with_heuristic_function(
+                const heuristic_function<Node, Weight>* heuristic_function) {
+            return search(*m_source,
+                          m_targets,
+                          *m_weight_function,
+                          *heuristic_function);
+        }
+        
+    private:
+        Node* m_source;
+        std::vector<Node*> m_targets;
+        const weight_function<Node, Weight>* m_weight_function;
+    };
+    
+    template<typename Node, typename Weight>
+    class target_set_weight_function_selector {
+    public:
+        target_set_weight_function_selector(Node& source,
+                                            const std::vector<Node*>& targets)
+        :
+        m_source{&source},
+        m_targets{targets} {}
+        
+        target_set_heuristic_function_selector<Node, Weight>
+        with_weights(const weight_function<Node, Weight>* wf) {
+            return target_set_heuristic_function_selector<Node, Weight>(
+                                                                *m_source,
+                                                                m_targets,
+                                                                wf);
+        }
+        
     private:
-        Node m_source;
-        Node m_target;
+        Node* m_source;
+        std::vector<Node*> m_targets;
     };
     
     template<typename Node, typename Weight>
     class target_node_selector {
     public:
-        target_node_selector(Node source) : m_source{source} {}
+        target_node_selector(Node& source) : m_source{&source} {}
         weight_function_selector<Node, Weight> to(Node& target) {
-            return weight_function_selector<Node, Weight>(m_source, target);
+            return weight_function_selector<Node, Weight>(*m_source, target);
+        }
+        
+        // Searches for the closest of 'targets' instead of a single target.
+        target_set_weight_function_selector<Node, Weight>
+        to_any_of(const std::vector<Node*>& targets) {
+            return target_set_weight_function_selector<Node, Weight>(*m_source,
+                                                                     targets);
         }
         
     private:
-        Node m_source;
+        Node* m_source;
     };
     
     template<typename Node, typename Weight>
@@ -0,0 +1,374 @@
+#ifndef NET_CODERODDE_PATHFINDING_RELAXATION_KERNEL_HPP
+#define NET_CODERODDE_PATHFINDING_RELAXATION_KERNEL_HPP
+
+#include "cpu_features.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // Relaxes the 'count' edges leaving a node whose distance is
+    // 'base_distance'. The edge heads and weights are stored contiguously in
+    // 'heads' and 'weights'; 'distances' is indexed by node id. For every
+    // edge whose tentative distance is smaller than the current distance of
+    // its head, the head and the tentative distance are appended to
+    // 'improved_ids' and 'improved_distances', which must have room for
+    // 'count' entries. Returns the number of improved edges. Nothing is
+    // written to 'distances'; if a head occurs twice among the edges, both
+    // occurrences may be reported.
+    template<typename Weight>
+    std::size_t relax_edges_scalar(const std::uint32_t* heads,
+                                   const Weight* weights,
+                                   std::size_t count,
+                                   const Weight* distances,
+                                   Weight base_distance,
+                                   std::uint32_t* improved_ids,
+                                   Weight* improved_distances) {
+        std::size_t improved = 0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Weight tentative_distance = base_distance + weights[i];
+
+            if (distances[heads[i]] > tentative_distance) {
+                improved_ids[improved] = heads[i];
+                improved_distances[improved] = tentative_distance;
+                ++improved;
+            }
+        }
+
+        return improved;
+    }
+
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+
+    __attribute__((target("avx2")))
+    inline std::size_t relax_edges_avx2(const std::uint32_t* heads,
+                                        const std::int32_t* weights,
+                                        std::size_t count,
+                                        const std::int32_t* distances,
+                                        std::int32_t base_distance,
+                                        std::uint32_t* improved_ids,
+                                        std::int32_t* improved_distances) {
+        std::size_t improved = 0;
+        std::size_t i = 0;
+        const __m256i base = _mm256_set1_epi32(base_distance);
+
+        for (; i + 8 <= count; i += 8) {
+            __m256i ids = _mm256_loadu_si256(
+                                reinterpret_cast<const __m256i*>(heads + i));
+            __m256i edge_weights = _mm256_loadu_si256(
+                                reinterpret_cast<const __m256i*>(weights + i));
+            __m256i current = _mm256_i32gather_epi32(
+                                reinterpret_cast<const int*>(distances), ids, 4);
+            __m256i tentative = _mm256_add_epi32(base, edge_weights);
+            __m256i better = _mm256_cmpgt_epi32(current, tentative);
+
+            unsigned mask = static_cast<unsigned>(
+                        _mm256_movemask_ps(_mm256_castsi256_ps(better)));
+
+            if (mask == 0) {
+                continue;
+            }
+
+            alignas(32) std::int32_t tentative_array[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(tentative_array),
+                               tentative);
+
+            while (mask) {
+                unsigned lane = static_cast<unsigned>(__builtin_ctz(mask));
+                improved_ids[improved] = heads[i + lane];
+                improved_distances[improved] = tentative_array[lane];
+                ++improved;
+                mask &= mask - 1;
+            }
+        }
+
+        return improved + relax_edges_scalar(heads + i,
+                                             weights + i,
+                                             count - i,
+                                             distances,
+                                             base_distance,
+                                             improved_ids + improved,
+                                             improved_distances + improved);
+    }
+
+    __attribute__((target("avx2")))
+    inline std::size_t relax_edges_avx2(const std::uint32_t* heads,
+                                        const float* weights,
+                                        std::size_t count,
+                                        const float* distances,
+                                        float base_distance,
+                                        std::uint32_t* improved_ids,
+                                        float* improved_distances) {
+        std::size_t improved = 0;
+        std::size_t i = 0;
+        const __m256 base = _mm256_set1_ps(base_distance);
+
+        for (; i + 8 <= count; i += 8) {
+            __m256i ids = _mm256_loadu_si256(
+                                reinterpret_cast<const __m256i*>(heads + i));
+            __m256 edge_weights = _mm256_loadu_ps(weights + i);
+            __m256 current = _mm256_i32gather_ps(distances, ids, 4);
+            __m256 tentative = _mm256_add_ps(base, edge_weights);
+            __m256 better = _mm256_cmp_ps(current, tentative, _CMP_GT_OQ);
+
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(better));
+
+            if (mask == 0) {
+                continue;
+            }
+
+            alignas(32) float tentative_array[8];
+            _mm256_store_ps(tentative_array, tentative);
+
+            while (mask) {
+                unsigned lane = static_cast<unsigned>(__builtin_ctz(mask));
+                improved_ids[improved] = heads[i + lane];
+                improved_distances[improved] = tentative_array[lane];
+                ++improved;
+                mask &= mask - 1;
+            }
+        }
+
+        return improved + relax_edges_scalar(heads + i,
+                                             weights + i,
+                                             count - i,
+                                             distances,
+                                             base_distance,
+                                             improved_ids + improved,
+                                             improved_distances + improved);
+    }
+
+    __attribute__((target("avx512f")))
+    inline std::size_t relax_edges_avx512(const std::uint32_t* heads,
+                                          const std::int32_t* weights,
+                                          std::size_t count,
+                                          const std::int32_t* distances,
+                                          std::int32_t base_distance,
+                                          std::uint32_t* improved_ids,
+                                          std::int32_t* improved_distances) {
+        std::size_t improved = 0;
+        std::size_t i = 0;
+        const __m512i base = _mm512_set1_epi32(base_distance);
+
+        for (; i + 16 <= count; i += 16) {
+            __m512i ids = _mm512_loadu_si512(heads + i);
+            __m512i edge_weights = _mm512_loadu_si512(weights + i);
+            __m512i current = _mm512_mask_i32gather_epi32(
+                                _mm512_setzero_si512(), 0xFFFF, ids, distances, 4);
+            __m512i tentative = _mm512_add_epi32(base, edge_weights);
+            __mmask16 better = _mm512_cmpgt_epi32_mask(current, tentative);
+
+            if (better == 0) {
+                continue;
+            }
+
+            _mm512_mask_compressstoreu_epi32(improved_ids + improved,
+                                             better,
+                                             ids);
+            _mm512_mask_compressstoreu_epi32(improved_distances + improved,
+                                             better,
+                                             tentative);
+            improved += static_cast<std::size_t>(__builtin_popcount(better));
+        }
+
+        return improved + relax_edges_scalar(heads + i,
+                                             weights + i,
+                                             count - i,
+                                             distances,
+                                             base_distance,
+                                             improved_ids + improved,
+                                             improved_distances + improved);
+    }
+
+    __attribute__((target("avx512f")))
+    inline std::size_t relax_edges_avx512(const std::uint32_t* heads,
+                                          const float* weights,
+                                          std::size_t count,
+                                          const float* distances,
+                                          float base_distance,
+                                          std::uint32_t* improved_ids,
+                                          float* improved_distances) {
+        std::size_t improved = 0;
+        std::size_t i = 0;
+        const __m512 base = _mm512_set1_ps(base_distance);
+
+        for (; i + 16 <= count; i += 16) {
+            __m512i ids = _mm512_loadu_si512(heads + i);
+            __m512 edge_weights = _mm512_loadu_ps(weights + i);
+            __m512 current = _mm512_mask_i32gather_ps(
+                                _mm512_setzero_ps(), 0xFFFF, ids, distances, 4);
+            __m512 tentative = _mm512_add_ps(base, edge_weights);
+            __mmask16 better = _mm512_cmp_ps_mask(current,
+                                                  tentative,
+                                                  _CMP_GT_OQ);
+
+            if (better == 0) {
+                continue;
+            }
+
+            _mm512_mask_compressstoreu_epi32(improved_ids + improved,
+                                             better,
+                                             ids);
+            _mm512_mask_compressstoreu_ps(improved_distances + improved,
+                                          better,
+                                          tentative);
+            improved += static_cast<std::size_t>(__builtin_popcount(better));
+        }
+
+        return improved + relax_edges_scalar(heads + i,
+                                             weights + i,
+                                             count - i,
+                                             distances,
+                                             base_distance,
+                                             improved_ids + improved,
+                                             improved_distances + improved);
+    }
+
+#endif // NET_CODERODDE_PATHFINDING_X86_SIMD
+
+    // Weight types without a vectorized kernel use the scalar loop.
+    template<typename Weight>
+    std::size_t relax_edges(const std::uint32_t* heads,
+                            const Weight* weights,
+                            std::size_t count,
+                            const Weight* distances,
+                            Weight base_distance,
+                            std::uint32_t* improved_ids,
+                            Weight* improved_distances) {
+        return relax_edges_scalar(heads,
+                                  weights,
+                                  count,
+                                  distances,
+                                  base_distance,
+                                  improved_ids,
+                                  improved_distances);
+    }
+
+    inline std::size_t relax_edges(const std::uint32_t* heads,
+                                   const std::int32_t* weights,
+                                   std::size_t count,
+                                   const std::int32_t* distances,
+                                   std::int32_t base_distance,
+                                   std::uint32_t* improved_ids,
+                                   std::int32_t* improved_distances) {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+        switch (supported_simd_level()) {
+            case simd_level::avx512:
+                return relax_edges_avx512(heads,
+                                          weights,
+                                          count,
+                                          distances,
+                                          base_distance,
+                                          improved_ids,
+                                          improved_distances);
+
+            case simd_level::avx2:
+                return relax_edges_avx2(heads,
+                                        weights,
+                                        count,
+                                        distances,
+                                        base_distance,
+                                        improved_ids,
+                                        improved_distances);
+
+            default:
+                break;
+        }
+#endif
+        return relax_edges_scalar(heads,
+                                  weights,
+                                  count,
+                                  distances,
+                                  base_distance,
+                                  improved_ids,
+                                  improved_distances);
+    }
+
+    inline std::size_t relax_edges(const std::uint32_t* heads,
+                                   const float* weights,
+                                   std::size_t count,
+                                   const float* distances,
+                                   float base_distance,
+                                   std::uint32_t* improved_ids,
+                                   float* improved_distances) {
+#ifdef NET_CODERODDE_PATHFINDING_X86_SIMD
+        switch (supported_simd_level()) {
+            case simd_level::avx512:
+                return relax_edges_avx512(heads,
+                                          weights,
+                                          count,
+                                          distances,
+                                          base_distance,
+                                          improved_ids,
+                                          improved_distances);
+
+            case simd_level::avx2:
+                return relax_edges_avx2(heads,
+                                        weights,
+                                        count,
+                                        distances,
+                                        base_distance,
+                                        improved_ids,
+                                        improved_distances);
+
+            default:
+                break;
+        }
+#endif
+        return relax_edges_scalar(heads,
+                                  weights,
+                                  count,
+                                  distances,
+                                  base_distance,
+                                  improved_ids,
+                                  improved_distances);
+    }
+
+    // Relaxes the edges like 'relax_edges()', then drops the heads that are
+    // closed or that an earlier parallel edge already reached at least as
+    // cheaply, and writes the distances of the others to 'distances'. The
+    // kept heads and their distances are moved to the front of
+    // 'improved_ids' and 'improved_distances'; returns their number.
+    template<typename Weight>
+    std::size_t relax_open_edges(const std::uint32_t* heads,
+                                 const Weight* weights,
+                                 std::size_t count,
+                                 Weight* distances,
+                                 const char* closed,
+                                 Weight base_distance,
+                                 std::uint32_t* improved_ids,
+                                 Weight* improved_distances) {
+        std::size_t improved = relax_edges(heads,
+                                           weights,
+                                           count,
+                                           distances,
+                                           base_distance,
+                                           improved_ids,
+                                           improved_distances);
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < improved; ++i) {
+            std::uint32_t id = improved_ids[i];
+            Weight tentative_distance = improved_distances[i];
+
+            if (closed[id] || !(distances[id] > tentative_distance)) {
+                continue;
+            }
+
+            distances[id] = tentative_distance;
+            improved_ids[kept] = id;
+            improved_distances[kept] = tentative_distance;
+            ++kept;
+        }
+
+        return kept;
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_RELAXATION_KERNEL_HPP
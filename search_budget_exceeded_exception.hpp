@@ -0,0 +1,50 @@
+#ifndef NET_CODERODDE_PATHFINDING_SEARCH_BUDGET_EXCEEDED_EXCEPTION_HPP
+#define NET_CODERODDE_PATHFINDING_SEARCH_BUDGET_EXCEEDED_EXCEPTION_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+    
+    // Thrown when a search would need more memory or more expansions than it
+    // was allowed. 'budget()' is the exceeded limit, in bytes or expansions.
+    class search_budget_exceeded_exception : public virtual std::runtime_error {
+    public:
+        search_budget_exceeded_exception(const std::string& what,
+                                         std::size_t budget)
+        :
+        std::runtime_error{what},
+        m_budget{budget}
+        {}
+        
+        static search_budget_exceeded_exception memory(std::size_t bytes) {
+            return search_budget_exceeded_exception(
+                        "The search exceeded its memory budget of "
+                        + std::to_string(bytes) + " bytes.",
+                        bytes);
+        }
+        
+        static search_budget_exceeded_exception
+        expansions(std::size_t expansions) {
+            return search_budget_exceeded_exception(
+                        "The search exceeded its limit of "
+                        + std::to_string(expansions) + " expansions.",
+                        expansions);
+        }
+        
+        std::size_t budget() const {
+            return m_budget;
+        }
+        
+    private:
+        std::size_t m_budget;
+    };
+    
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_SEARCH_BUDGET_EXCEEDED_EXCEPTION_HPP
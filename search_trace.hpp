@@ -0,0 +1,364 @@
+#ifndef NET_CODERODDE_PATHFINDING_SEARCH_TRACE_HPP
+#define NET_CODERODDE_PATHFINDING_SEARCH_TRACE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    // Trace file layout: the 8-byte magic "PFTRACE1", the record size as a
+    // 32-bit integer, then 16-byte 'trace_record's in host byte order.
+    // Records of one query are in order; records of different queries may
+    // interleave. Query number 0 is reserved: a record of that query
+    // carries in its key the number of records a ring dropped since its
+    // previous such record.
+    enum class trace_event : std::uint32_t {
+        query_begin = 0, // key = source, value = 0
+        expansion   = 1, // key = expanded node, value = open list size
+        relaxation  = 2, // key = improved child of the last expanded node
+        query_end   = 3  // key = goal reached (or 0), value = 1 if found
+    };
+
+    struct trace_record {
+        std::uint64_t m_key;
+        std::uint32_t m_query;
+        std::uint32_t m_event_and_value;
+
+        static const std::uint32_t value_bits = 30;
+        static const std::uint32_t value_mask = (1u << value_bits) - 1;
+
+        trace_event event() const {
+            return static_cast<trace_event>(m_event_and_value >> value_bits);
+        }
+
+        // Saturates at 2^30 - 1.
+        std::uint32_t value() const {
+            return m_event_and_value & value_mask;
+        }
+    };
+
+    const char trace_file_magic[8] = { 'P', 'F', 'T', 'R', 'A', 'C', 'E', '1' };
+
+    const std::uint32_t dropped_records_query = 0;
+
+    // Maps a node to the 64-bit key stored in the trace. The default uses
+    // the node's address; specialize it to get stable keys, for example
+    // 'grid_trace_key(x, y)' for grid nodes, which the replay tool can turn
+    // back into coordinates.
+    template<typename Node>
+    struct trace_key {
+        std::uint64_t operator()(const Node& node) const {
+            return static_cast<std::uint64_t>(
+                                reinterpret_cast<std::uintptr_t>(&node));
+        }
+    };
+
+    inline std::uint64_t grid_trace_key(std::uint32_t x, std::uint32_t y) {
+        return (static_cast<std::uint64_t>(x) << 32) | y;
+    }
+
+    // A single-producer, single-consumer ring of trace records. The owning
+    // thread appends without locking; when the ring is full the record is
+    // dropped and counted.
+    class trace_ring {
+    public:
+        explicit trace_ring(std::size_t capacity)
+        :
+        m_records(capacity),
+        m_mask{capacity - 1},
+        m_head{0},
+        m_tail{0},
+        m_dropped{0},
+        m_reported_dropped{0},
+        m_query_counter{0}
+        {}
+
+        void push(const trace_record& record) {
+            std::size_t head = m_head.load(std::memory_order_relaxed);
+            std::size_t tail = m_tail.load(std::memory_order_acquire);
+
+            if (head - tail == m_records.size()) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            m_records[head & m_mask] = record;
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        // Writes all pending records to 'file', followed by a record of
+        // 'dropped_records_query' if records were dropped since the last
+        // call. Only one thread at a time may drain a ring.
+        void drain(std::FILE* file) {
+            std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            std::size_t head = m_head.load(std::memory_order_acquire);
+
+            while (tail != head) {
+                std::size_t begin = tail & m_mask;
+                std::size_t length = std::min(head - tail,
+                                              m_records.size() - begin);
+                std::fwrite(&m_records[begin], sizeof(trace_record), length, file);
+                tail += length;
+            }
+
+            m_tail.store(tail, std::memory_order_release);
+
+            std::uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+
+            if (dropped != m_reported_dropped) {
+                trace_record notice;
+                notice.m_key = dropped - m_reported_dropped;
+                notice.m_query = dropped_records_query;
+                notice.m_event_and_value = 0;
+                std::fwrite(&notice, sizeof(trace_record), 1, file);
+                m_reported_dropped = dropped;
+            }
+        }
+
+        std::uint64_t dropped() const {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        // Used by the owning thread only, for sampling.
+        std::uint64_t next_query_number() {
+            return m_query_counter++;
+        }
+
+    private:
+        std::vector<trace_record>  m_records;
+        std::size_t                m_mask;
+        std::atomic<std::size_t>   m_head;
+        std::atomic<std::size_t>   m_tail;
+        std::atomic<std::uint64_t> m_dropped;
+        std::uint64_t              m_reported_dropped;
+        std::uint64_t              m_query_counter;
+    };
+
+    // The trace of one query. A default-constructed (or unsampled)
+    // 'query_trace' is inactive and records nothing.
+    class query_trace {
+    public:
+        query_trace() : m_ring{nullptr}, m_query{0} {}
+
+        query_trace(trace_ring* ring, std::uint32_t query)
+        :
+        m_ring{ring},
+        m_query{query}
+        {}
+
+        bool active() const {
+            return m_ring != nullptr;
+        }
+
+        void begin(std::uint64_t source_key) {
+            record(trace_event::query_begin, source_key, 0);
+        }
+
+        void expansion(std::uint64_t key, std::size_t open_size) {
+            record(trace_event::expansion, key, open_size);
+        }
+
+        void relaxation(std::uint64_t key) {
+            record(trace_event::relaxation, key, 0);
+        }
+
+        void end(std::uint64_t goal_key, bool found) {
+            record(trace_event::query_end, goal_key, found ? 1 : 0);
+        }
+
+    private:
+        void record(trace_event event, std::uint64_t key, std::size_t value) {
+            if (!m_ring) {
+                return;
+            }
+
+            std::size_t limit = trace_record::value_mask;
+            std::uint32_t clamped =
+            static_cast<std::uint32_t>(std::min(value, limit));
+            trace_record r;
+            r.m_key = key;
+            r.m_query = m_query;
+            r.m_event_and_value =
+            (static_cast<std::uint32_t>(event) << trace_record::value_bits)
+            | clamped;
+
+            m_ring->push(r);
+        }
+
+        trace_ring*   m_ring;
+        std::uint32_t m_query;
+    };
+
+    // Collects search traces from any number of threads into one file. Each
+    // thread writes into its own ring, so recording takes no locks; only
+    // every 'sample_every'-th query of a thread is traced. The rings are
+    // drained by 'flush()', by a background thread every
+    // 'flush_interval_ms' milliseconds (if nonzero) and on destruction.
+    class trace_recorder {
+    public:
+        trace_recorder(const std::string& file_name,
+                       std::uint64_t sample_every = 1,
+                       std::size_t ring_capacity = 1 << 16,
+                       unsigned flush_interval_ms = 100)
+        :
+        m_sample_every{std::max<std::uint64_t>(1, sample_every)},
+        m_ring_capacity{ring_capacity},
+        m_next_query{1},
+        m_id{next_recorder_id()},
+        m_stopping{false}
+        {
+            if (ring_capacity == 0 || (ring_capacity & (ring_capacity - 1))) {
+                throw std::invalid_argument{
+                    "ring_capacity must be a power of two."};
+            }
+
+            m_file = std::fopen(file_name.c_str(), "wb");
+
+            if (!m_file) {
+                throw std::runtime_error{"Cannot open " + file_name};
+            }
+
+            std::uint32_t record_size = sizeof(trace_record);
+            std::fwrite(trace_file_magic, 1, sizeof(trace_file_magic), m_file);
+            std::fwrite(&record_size, sizeof(record_size), 1, m_file);
+
+            if (flush_interval_ms > 0) {
+                m_flusher = std::thread([this, flush_interval_ms]() {
+                    std::unique_lock<std::mutex> lock(m_stop_mutex);
+
+                    while (!m_stopping) {
+                        m_stop_condition.wait_for(
+                                lock,
+                                std::chrono::milliseconds(flush_interval_ms));
+                        flush();
+                    }
+                });
+            }
+        }
+
+        trace_recorder(const trace_recorder&) = delete;
+        trace_recorder& operator=(const trace_recorder&) = delete;
+
+        ~trace_recorder() {
+            if (m_flusher.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(m_stop_mutex);
+                    m_stopping = true;
+                }
+
+                m_stop_condition.notify_one();
+                m_flusher.join();
+            }
+
+            flush();
+            std::fclose(m_file);
+        }
+
+        // Starts tracing a query on the calling thread. Returns an inactive
+        // trace if the query is not sampled.
+        query_trace begin_query(std::uint64_t source_key) {
+            trace_ring* ring = ring_of_this_thread();
+
+            if (ring->next_query_number() % m_sample_every != 0) {
+                return query_trace{};
+            }
+
+            std::uint32_t query = m_next_query.fetch_add(1);
+
+            if (query == dropped_records_query) {
+                query = m_next_query.fetch_add(1);
+            }
+
+            query_trace trace(ring, query);
+            trace.begin(source_key);
+            return trace;
+        }
+
+        void flush() {
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+
+            for (auto& entry : m_rings) {
+                entry.second->drain(m_file);
+            }
+
+            std::fflush(m_file);
+        }
+
+        std::uint64_t dropped_records() const {
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            std::uint64_t total = 0;
+
+            for (auto& entry : m_rings) {
+                total += entry.second->dropped();
+            }
+
+            return total;
+        }
+
+    private:
+        static std::uint64_t next_recorder_id() {
+            static std::atomic<std::uint64_t> counter{0};
+            return ++counter;
+        }
+
+        trace_ring* ring_of_this_thread() {
+            // One-entry cache per thread; recorder ids are never reused, so a
+            // stale entry cannot be mistaken for a live one.
+            struct cached_ring {
+                std::uint64_t m_recorder_id;
+                trace_ring*   m_ring;
+            };
+
+            thread_local cached_ring cache{0, nullptr};
+
+            if (cache.m_recorder_id == m_id) {
+                return cache.m_ring;
+            }
+
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            std::unique_ptr<trace_ring>& ring =
+            m_rings[std::this_thread::get_id()];
+
+            if (!ring) {
+                ring.reset(new trace_ring(m_ring_capacity));
+            }
+
+            cache.m_recorder_id = m_id;
+            cache.m_ring = ring.get();
+            return ring.get();
+        }
+
+        std::FILE*                   m_file;
+        std::uint64_t                m_sample_every;
+        std::size_t                  m_ring_capacity;
+        std::atomic<std::uint32_t>   m_next_query;
+        std::uint64_t                m_id;
+
+        mutable std::mutex m_rings_mutex;
+        std::unordered_map<std::thread::id, std::unique_ptr<trace_ring>> m_rings;
+
+        std::mutex              m_stop_mutex;
+        std::condition_variable m_stop_condition;
+        bool                    m_stopping;
+        std::thread             m_flusher;
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_SEARCH_TRACE_HPP
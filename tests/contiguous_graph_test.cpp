@@ -0,0 +1,184 @@
+// Checks the contiguous_graph search against the node-based search and the
+// vectorized edge relaxation against the scalar loop.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/contiguous_graph_test.cpp -o contiguous_graph_test
+//   ./contiguous_graph_test
+
+#include "contiguous_search.hpp"
+#include "pathfinding.hpp"
+#include "relaxation_kernel.hpp"
+#include "tests/test_support.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+class float_weight_function :
+public virtual weight_function<grid_cell, float> {
+public:
+    float operator()(const grid_cell& tail, const grid_cell& head) const {
+        return 0.5f + static_cast<float>((tail.y() * 5 + head.x()) % 7) / 4;
+    }
+};
+
+// The dispatched kernel must report the same edges as the scalar loop.
+template<typename Weight>
+static void check_relaxation(std::mt19937& random) {
+    const std::size_t node_count = 200;
+    std::uniform_int_distribution<std::uint32_t> pick(0, node_count - 1);
+    std::uniform_int_distribution<int> value(0, 100);
+
+    for (std::size_t count = 0; count < 70; ++count) {
+        std::vector<std::uint32_t> heads(count);
+        std::vector<Weight> weights(count);
+        std::vector<Weight> distances(node_count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            heads[i] = pick(random);
+            weights[i] = static_cast<Weight>(value(random));
+        }
+
+        for (Weight& distance : distances) {
+            distance = value(random) < 20 ? unreached_distance<Weight>()
+                                          : static_cast<Weight>(value(random));
+        }
+
+        std::vector<std::uint32_t> ids(count);
+        std::vector<Weight> improved(count);
+        std::vector<std::uint32_t> expected_ids(count);
+        std::vector<Weight> expected_improved(count);
+        Weight base = static_cast<Weight>(value(random));
+
+        std::size_t n = relax_edges(heads.data(),
+                                    weights.data(),
+                                    count,
+                                    distances.data(),
+                                    base,
+                                    ids.data(),
+                                    improved.data());
+        std::size_t expected = relax_edges_scalar(heads.data(),
+                                                  weights.data(),
+                                                  count,
+                                                  distances.data(),
+                                                  base,
+                                                  expected_ids.data(),
+                                                  expected_improved.data());
+        CHECK(n == expected);
+        CHECK(std::equal(ids.begin(), ids.begin() + n, expected_ids.begin()));
+        CHECK(std::equal(improved.begin(),
+                         improved.begin() + n,
+                         expected_improved.begin()));
+    }
+}
+
+// Closed heads are dropped, and a parallel edge is kept only if it is
+// shorter than the one before it.
+static void check_open_relaxation() {
+    const std::uint32_t heads[] = {1, 2, 1, 3, 1, 0};
+    const int weights[] = {5, 1, 7, 2, 3, 1};
+    int distances[] = {100, 100, 100, 1, 100};
+    const char closed[] = {1, 0, 0, 0, 0};
+    std::uint32_t ids[6];
+    int improved[6];
+
+    std::size_t n = relax_open_edges(heads,
+                                     weights,
+                                     6,
+                                     distances,
+                                     closed,
+                                     10,
+                                     ids,
+                                     improved);
+    CHECK(n == 3);
+    CHECK(ids[0] == 1 && improved[0] == 15);
+    CHECK(ids[1] == 2 && improved[1] == 11);
+    CHECK(ids[2] == 1 && improved[2] == 13);
+    CHECK(distances[1] == 13 && distances[2] == 11 && distances[3] == 1);
+    CHECK(distances[0] == 100 && distances[4] == 100);
+}
+
+template<typename Weight>
+static void check_searches(grid& cells,
+                           const weight_function<grid_cell, Weight>& w) {
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    contiguous_graph<grid_cell, Weight> graph(nodes, w);
+    std::mt19937 random(17);
+    std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+
+    CHECK(graph.node_count() == nodes.size());
+
+    for (int query = 0; query < 100; ++query) {
+        grid_cell& source = *nodes[pick(random)];
+        grid_cell& target = *nodes[pick(random)];
+        Weight expected = -1;
+        Weight actual = -1;
+
+        try {
+            expected = search(source, target, w).total_weight();
+        } catch (path_not_found_exception<grid_cell>&) {
+        }
+
+        try {
+            actual = search(graph, source, target).total_weight();
+        } catch (path_not_found_exception<grid_cell>&) {
+        }
+
+        CHECK(std::abs(expected - actual) < 1e-3);
+    }
+}
+
+static bool rejects(std::vector<std::size_t> offsets,
+                    std::vector<std::uint32_t> heads) {
+    grid cells = make_grid(3, 1, 0.0, 1);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    std::vector<int> weights(heads.size(), 1);
+
+    try {
+        contiguous_graph<grid_cell, int> graph(nodes, offsets, heads, weights);
+    } catch (std::invalid_argument&) {
+        return true;
+    }
+
+    return false;
+}
+
+int main() {
+    std::mt19937 random(1);
+    check_relaxation<std::int32_t>(random);
+    check_relaxation<float>(random);
+    check_relaxation<double>(random);
+    check_open_relaxation();
+
+    grid cells = make_grid(50, 40, 0.25, 9);
+    check_searches<int>(cells, grid_weight_function());
+    check_searches<float>(cells, float_weight_function());
+
+    // Prebuilt arrays are validated.
+    CHECK(!rejects({0, 1, 2, 2}, {1, 2}));
+    CHECK(rejects({0, 1, 2}, {1, 2}));
+    CHECK(rejects({1, 1, 2, 2}, {1, 2}));
+    CHECK(rejects({0, 2, 1, 2}, {1, 2}));
+    CHECK(rejects({0, 1, 2, 3}, {1, 2}));
+    CHECK(rejects({0, 1, 2, 2}, {1, 3}));
+
+    // Nodes outside the graph have no id.
+    grid other = make_grid(2, 2, 0.0, 1);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    contiguous_graph<grid_cell, int> graph(nodes, grid_weight_function());
+    bool thrown = false;
+
+    try {
+        graph.id_of(other[0][0]);
+    } catch (std::out_of_range&) {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    return report("contiguous_graph_test");
+}
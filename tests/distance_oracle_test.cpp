@@ -0,0 +1,176 @@
+// Compares the all-pairs distances of both oracle methods with each other
+// and with single searches, and checks the paths the oracle walks.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/distance_oracle_test.cpp -o distance_oracle_test
+//   ./distance_oracle_test
+
+#include "pathfinding.hpp"
+#include "tests/test_support.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+class float_weight_function :
+public virtual weight_function<grid_cell, float> {
+public:
+    float operator()(const grid_cell& tail, const grid_cell& head) const {
+        return 0.25f + static_cast<float>((tail.x() * 31 + head.x() * 17
+                                           + tail.y() * 5) % 20) / 8;
+    }
+};
+
+class dense_weight_function :
+public virtual weight_function<grid_cell, int> {
+public:
+    int operator()(const grid_cell& tail, const grid_cell& head) const {
+        return 1 + (tail.x() * 31 + head.x() * 17) % 20;
+    }
+};
+
+template<typename Weight>
+static bool close(Weight a, Weight b) {
+    return std::abs(a - b) <= 1e-4 * std::max<Weight>(1, std::abs(b));
+}
+
+// Checks that 'path' is a chain of edges from 'source' to 'target' whose
+// weights add up to the reported total.
+template<typename Weight>
+static void check_path(const weighted_path<grid_cell, Weight>& path,
+                       grid_cell& source,
+                       grid_cell& target,
+                       const weight_function<grid_cell, Weight>& w) {
+    CHECK(&path.node_at(0) == &source);
+    CHECK(&path.node_at(path.size() - 1) == &target);
+    Weight total{};
+
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        bool is_child = false;
+
+        for (grid_cell& child : path.node_at(i - 1)) {
+            is_child = is_child || &child == &path.node_at(i);
+        }
+
+        CHECK(is_child);
+        total += w(path.node_at(i - 1), path.node_at(i));
+    }
+
+    CHECK(close(total, path.total_weight()));
+}
+
+template<typename Weight>
+static void check_oracles(std::vector<grid_cell*>& nodes,
+                          const weight_function<grid_cell, Weight>& w) {
+    distance_oracle<grid_cell, Weight> floyd_warshall(
+                                        nodes,
+                                        w,
+                                        all_pairs_method::floyd_warshall);
+    distance_oracle<grid_cell, Weight> dijkstra(
+                                        nodes,
+                                        w,
+                                        all_pairs_method::repeated_dijkstra);
+    distance_oracle<grid_cell, Weight> automatic(nodes, w);
+    int unreachable = 0;
+
+    for (grid_cell* source : nodes) {
+        for (grid_cell* target : nodes) {
+            bool reachable = floyd_warshall.is_reachable(*source, *target);
+            CHECK(dijkstra.is_reachable(*source, *target) == reachable);
+            CHECK(automatic.is_reachable(*source, *target) == reachable);
+
+            if (!reachable) {
+                ++unreachable;
+                bool thrown = false;
+
+                try {
+                    floyd_warshall.total_weight(*source, *target);
+                } catch (path_not_found_exception<grid_cell>&) {
+                    thrown = true;
+                }
+
+                CHECK(thrown);
+                continue;
+            }
+
+            Weight distance = floyd_warshall.total_weight(*source, *target);
+            CHECK(close(dijkstra.total_weight(*source, *target), distance));
+            CHECK(close(automatic.total_weight(*source, *target), distance));
+        }
+    }
+
+    CHECK(unreachable > 0);
+
+    // Paths, and distances against the node-based search.
+    std::mt19937 random(4);
+    std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+
+    for (int query = 0; query < 100; ++query) {
+        grid_cell& source = *nodes[pick(random)];
+        grid_cell& target = *nodes[pick(random)];
+
+        try {
+            Weight expected = search(source, target, w).total_weight();
+            CHECK(close(floyd_warshall.total_weight(source, target), expected));
+            check_path(floyd_warshall.path(source, target), source, target, w);
+            check_path(dijkstra.path(source, target), source, target, w);
+            check_path(find_shortest_path<grid_cell, Weight>()
+                       .from(source)
+                       .to(target)
+                       .with_oracle(&automatic),
+                       source,
+                       target,
+                       w);
+        } catch (path_not_found_exception<grid_cell>&) {
+            CHECK(!floyd_warshall.is_reachable(source, target));
+        }
+    }
+}
+
+int main() {
+    // A sparse grid with walls, so some pairs are unreachable.
+    grid cells = make_grid(20, 15, 0.3, 8);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    check_oracles<int>(nodes, grid_weight_function());
+    check_oracles<float>(nodes, float_weight_function());
+
+    // A dense random digraph spanning several Floyd-Warshall blocks; the
+    // last node has no edges in or out.
+    grid dense = make_grid(150, 1, 0.0, 1);
+    std::mt19937 random(9);
+    std::bernoulli_distribution has_edge(0.3);
+
+    for (auto& cell : dense[0]) {
+        cell.clear_children();
+    }
+
+    for (int tail = 0; tail < 149; ++tail) {
+        for (int head = 0; head < 149; ++head) {
+            if (tail != head && has_edge(random)) {
+                dense[0][tail].add_child(dense[0][head]);
+            }
+        }
+    }
+
+    std::vector<grid_cell*> dense_nodes = cell_pointers(dense);
+    check_oracles<int>(dense_nodes, dense_weight_function());
+
+    // A single node reaches only itself.
+    grid single = make_grid(1, 1, 0.0, 1);
+    std::vector<grid_cell*> single_nodes = cell_pointers(single);
+    grid_weight_function w;
+    distance_oracle<grid_cell, int> oracle(single_nodes, w);
+    CHECK(oracle.node_count() == 1);
+    CHECK(oracle.is_reachable(single[0][0], single[0][0]));
+    CHECK(oracle.total_weight(single[0][0], single[0][0]) == 0);
+    CHECK(oracle.path(single[0][0], single[0][0]).size() == 1);
+    check_path(oracle.path(single[0][0], single[0][0]),
+               single[0][0],
+               single[0][0],
+               w);
+
+    return report("distance_oracle_test");
+}
@@ -0,0 +1,217 @@
+// Compares the out-of-core search with the in-memory contiguous search,
+// checks when its state spills to files and that damaged graph files are
+// rejected.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/external_search_test.cpp -o external_search_test
+//   ./external_search_test
+
+#include "contiguous_search.hpp"
+#include "external_search.hpp"
+#include "metric_heuristics.hpp"
+#include "tests/test_support.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+static const char* const graph_file = "external_search_test.graph";
+
+// Reads the coordinates of a node id from the cell it was written from.
+class id_coordinates {
+public:
+    explicit id_coordinates(const contiguous_graph<grid_cell, int>* graph)
+    :
+    m_graph{graph}
+    {}
+
+    double x(std::uint32_t id) const {
+        return m_graph->node_at(id).x();
+    }
+
+    double y(std::uint32_t id) const {
+        return m_graph->node_at(id).y();
+    }
+
+private:
+    const contiguous_graph<grid_cell, int>* m_graph;
+};
+
+static int in_memory_distance(const contiguous_graph<grid_cell, int>& graph,
+                              std::uint32_t source,
+                              std::uint32_t target) {
+    try {
+        return search(graph,
+                      graph.node_at(source),
+                      graph.node_at(target)).total_weight();
+    } catch (path_not_found_exception<grid_cell>&) {
+        return -1;
+    }
+}
+
+static int external_distance(external_graph<int>& graph,
+                             std::uint32_t source,
+                             std::uint32_t target,
+                             const heuristic_function<std::uint32_t, int>& h,
+                             std::size_t memory_budget) {
+    try {
+        external_path<int> path = search(graph, source, target, h, memory_budget);
+        CHECK(path.node_at(0) == source);
+        CHECK(path.node_at(path.size() - 1) == target);
+        return path.total_weight();
+    } catch (external_path_not_found_exception& e) {
+        CHECK(e.source() == source);
+        CHECK(e.target() == target);
+        return -1;
+    }
+}
+
+// Overwrites 4 bytes of the graph file at 'offset'.
+static void patch(std::size_t offset, std::uint32_t value) {
+    std::fstream file(graph_file,
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static bool is_rejected(std::size_t cache_bytes) {
+    try {
+        external_graph<int> graph(graph_file, cache_bytes);
+
+        for (std::uint32_t id = 0; id < graph.node_count(); ++id) {
+            const std::uint32_t* heads;
+            const int* weights;
+            graph.edges(id, heads, weights);
+        }
+    } catch (std::runtime_error&) {
+        return true;
+    }
+
+    return false;
+}
+
+int main() {
+    grid_weight_function w;
+    grid cells = make_grid(40, 30, 0.3, 21);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    contiguous_graph<grid_cell, int> graph(nodes, w);
+    write_external_graph(graph, graph_file, 64);
+
+    {
+        // A cache of four blocks forces evictions.
+        external_graph<int> disk(graph_file, 4 * 1024);
+        CHECK(disk.node_count() == graph.node_count());
+        CHECK(disk.edge_count() == graph.edge_count());
+
+        std::mt19937 random(5);
+        std::uniform_int_distribution<std::uint32_t> pick(
+                                    0,
+                                    static_cast<std::uint32_t>(nodes.size() - 1));
+        zero_heuristic<std::uint32_t, int> zero;
+
+        for (int query = 0; query < 40; ++query) {
+            std::uint32_t source = pick(random);
+            std::uint32_t target = pick(random);
+            manhattan_heuristic<std::uint32_t, int, id_coordinates>
+            h(target, 1.0, id_coordinates(&graph));
+            int expected = in_memory_distance(graph, source, target);
+
+            // Unlimited memory, then every state array spilled to disk.
+            CHECK(external_distance(disk, source, target, zero, SIZE_MAX)
+                  == expected);
+            CHECK(external_distance(disk, source, target, h, 0) == expected);
+        }
+
+        // Ids may be temporaries.
+        std::uint32_t last = static_cast<std::uint32_t>(nodes.size() - 1);
+        int expected = in_memory_distance(graph, 0, last);
+
+        try {
+            external_path<int> path = find_shortest_path(disk)
+                                      .from(0)
+                                      .to(last)
+                                      .within_memory_budget(0)
+                                      .without_heuristic_function();
+            CHECK(path.total_weight() == expected);
+            CHECK(path.io().m_spilled_bytes > 0);
+        } catch (external_path_not_found_exception&) {
+            CHECK(expected < 0);
+        }
+    }
+
+    // Room for the per-node arrays but not for a growing open list: the
+    // arrays start in memory and move to files during the search.
+    {
+        external_graph<int> disk(graph_file, 1 << 20);
+        const std::size_t array_bytes = nodes.size() * (sizeof(int)
+                                                      + sizeof(std::uint32_t)
+                                                      + sizeof(char));
+        std::mt19937 random(6);
+        std::uniform_int_distribution<std::uint32_t> pick(
+                                    0,
+                                    static_cast<std::uint32_t>(nodes.size() - 1));
+        std::uint32_t source;
+        std::uint32_t target;
+
+        do {
+            source = pick(random);
+            target = pick(random);
+        } while (in_memory_distance(graph, source, target) < 40);
+
+        external_path<int> roomy = search(disk,
+                                          source,
+                                          target,
+                                          array_bytes + (1 << 20));
+        external_path<int> tight = search(disk, source, target, array_bytes + 64);
+        int expected = in_memory_distance(graph, source, target);
+
+        CHECK(roomy.total_weight() == expected);
+        CHECK(roomy.io().m_spilled_bytes == 0);
+        CHECK(tight.total_weight() == expected);
+        CHECK(tight.io().m_spilled_bytes >= nodes.size() * sizeof(int));
+    }
+
+    CHECK(!is_rejected(1 << 20));
+
+    // The first block starts right after the 40-byte header with the
+    // offsets of its 65 nodes.
+    const std::size_t first_block = sizeof(external_graph_header);
+
+    patch(first_block, 1);
+    CHECK(is_rejected(1 << 20));
+
+    write_external_graph(graph, graph_file, 64);
+    patch(first_block + 4 * 10, 0xfffffff0u);
+    CHECK(is_rejected(1 << 20));
+
+    write_external_graph(graph, graph_file, 64);
+    patch(first_block + 4 * 64, 0x7fffffffu);
+    CHECK(is_rejected(1 << 20));
+
+    // A directory entry claiming a block too short for its offsets.
+    write_external_graph(graph, graph_file, 64);
+    {
+        std::ifstream in(graph_file, std::ios::binary);
+        external_graph_header header;
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        patch(static_cast<std::size_t>(header.m_directory_offset) + 8, 16);
+        patch(static_cast<std::size_t>(header.m_directory_offset) + 12, 0);
+    }
+    CHECK(is_rejected(1 << 20));
+
+    // A truncated file.
+    {
+        std::ofstream out(graph_file, std::ios::binary | std::ios::trunc);
+        out.write(external_graph_magic, sizeof(external_graph_magic));
+    }
+    CHECK(is_rejected(1 << 20));
+
+    std::remove(graph_file);
+    return report("external_search_test");
+}
@@ -0,0 +1,150 @@
+// Loads the small DIMACS and MovingAI files in tests/data and checks the
+// graphs, and that malformed files are rejected.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/graph_loaders_test.cpp -o graph_loaders_test
+//   ./graph_loaders_test
+
+#include "contiguous_search.hpp"
+#include "graph_loaders.hpp"
+#include "pathfinding.hpp"
+#include "tests/test_support.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+static const std::string data = "tests/data/";
+
+template<typename Load>
+static bool is_rejected(Load load) {
+    try {
+        load();
+    } catch (std::runtime_error&) {
+        return true;
+    }
+
+    return false;
+}
+
+template<typename Weight>
+static Weight distance(indexed_graph<Weight>& graph,
+                       std::uint32_t source,
+                       std::uint32_t target) {
+    typedef indexed_node<Weight> node;
+
+    try {
+        Weight contiguous = search(graph.graph(),
+                                   graph.node(source),
+                                   graph.node(target)).total_weight();
+        Weight node_based = search(graph.node(source),
+                                   graph.node(target),
+                                   graph.weights()).total_weight();
+        CHECK(std::abs(contiguous - node_based) < 1e-9);
+        return contiguous;
+    } catch (path_not_found_exception<node>&) {
+        return -1;
+    }
+}
+
+static void check_dimacs() {
+    indexed_graph<int> graph = load_dimacs<int>(data + "tiny.gr",
+                                                data + "tiny.co");
+    CHECK(graph.node_count() == 5);
+    CHECK(graph.edge_count() == 6);
+    CHECK(graph.node(1).x() == 3 && graph.node(1).y() == -1);
+    CHECK(graph.node(4).x() == -4 && graph.node(4).y() == 10);
+
+    // Ids come from the nodes; foreign nodes are still rejected.
+    for (std::uint32_t id = 0; id < graph.node_count(); ++id) {
+        CHECK(graph.graph().id_of(graph.node(id)) == id);
+    }
+
+    indexed_graph<int> other = load_dimacs<int>(data + "tiny.gr");
+    bool foreign_rejected = false;
+
+    try {
+        graph.graph().id_of(other.node(2));
+    } catch (std::out_of_range&) {
+        foreign_rejected = true;
+    }
+
+    CHECK(foreign_rejected);
+
+    CHECK(distance(graph, 0, 3) == 8);
+    CHECK(distance(graph, 3, 2) == 9);
+    CHECK(distance(graph, 2, 2) == 0);
+    CHECK(distance(graph, 0, 4) == -1);
+
+    // A reordered copy looks ids up by address instead.
+    contiguous_graph<indexed_node<int>, int> reordered = graph.graph();
+    node_id_mapping mapping = reordered.reorder({4, 3, 2, 1, 0});
+
+    for (std::uint32_t id = 0; id < graph.node_count(); ++id) {
+        CHECK(reordered.id_of(graph.node(id)) == mapping.to_new(id));
+    }
+
+    CHECK(search(reordered, graph.node(3), graph.node(2)).total_weight() == 9);
+
+    CHECK(is_rejected([]() {
+        load_dimacs<int>(data + "tiny.gr", data + "duplicate.co");
+    }));
+    CHECK(is_rejected([]() {
+        load_dimacs<int>(data + "wrong_arc_count.gr");
+    }));
+    CHECK(is_rejected([]() {
+        load_dimacs<int>(data + "out_of_range.gr");
+    }));
+    CHECK(is_rejected([]() {
+        load_dimacs<int>(data + "missing.gr");
+    }));
+}
+
+static void check_movingai() {
+    std::vector<movingai_scenario> scenarios =
+    load_movingai_scenarios(data + "tiny.map.scen");
+    indexed_graph<double> graph = load_movingai_map<double>(data + "tiny.map");
+
+    CHECK(scenarios.size() == 4);
+    CHECK(graph.node_count() == 6 * 4);
+    CHECK(graph.node(6 * 3 + 5).x() == 5 && graph.node(6 * 3 + 5).y() == 3);
+
+    // Blocked cells are nodes without edges.
+    CHECK(graph.graph().degree(2) == 0);
+    CHECK(graph.graph().degree(6 + 1) == 0);
+    CHECK(graph.graph().degree(0) == 2);
+
+    for (const movingai_scenario& scenario : scenarios) {
+        CHECK(scenario.m_map == "tiny.map");
+        CHECK(scenario.m_width == 6 && scenario.m_height == 4);
+
+        std::uint32_t start = scenario.m_start_y * scenario.m_width
+                            + scenario.m_start_x;
+        std::uint32_t goal = scenario.m_goal_y * scenario.m_width
+                           + scenario.m_goal_x;
+        CHECK(std::abs(distance(graph, start, goal)
+                       - scenario.m_optimal_length) < 1e-6);
+    }
+
+    CHECK(scenarios[1].m_bucket == 1);
+    CHECK(scenarios[2].m_start_x == 3 && scenarios[2].m_start_y == 1);
+
+    CHECK(is_rejected([]() {
+        load_movingai_map<double>(data + "short_row.map");
+    }));
+    CHECK(is_rejected([]() {
+        load_movingai_scenarios(data + "outside.map.scen");
+    }));
+    CHECK(is_rejected([]() {
+        load_movingai_map<double>(data + "tiny.gr");
+    }));
+}
+
+int main() {
+    check_dimacs();
+    check_movingai();
+    return report("graph_loaders_test");
+}
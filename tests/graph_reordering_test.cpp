@@ -0,0 +1,104 @@
+// Checks that the node orders are permutations and that reordering a
+// contiguous_graph keeps its edges and distances.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/graph_reordering_test.cpp -o graph_reordering_test
+//   ./graph_reordering_test
+
+#include "contiguous_search.hpp"
+#include "graph_reordering.hpp"
+#include "tests/test_support.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+static bool is_permutation(const std::vector<std::uint32_t>& order,
+                           std::size_t count) {
+    std::vector<std::uint32_t> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i] != i) {
+            return false;
+        }
+    }
+
+    return sorted.size() == count;
+}
+
+static int distance(const contiguous_graph<grid_cell, int>& graph,
+                    grid_cell& source,
+                    grid_cell& target) {
+    try {
+        return search(graph, source, target).total_weight();
+    } catch (path_not_found_exception<grid_cell>&) {
+        return -1;
+    }
+}
+
+static void check_order(grid& cells, const std::vector<std::uint32_t>& order) {
+    grid_weight_function w;
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    contiguous_graph<grid_cell, int> original(nodes, w);
+    contiguous_graph<grid_cell, int> reordered(nodes, w);
+
+    CHECK(is_permutation(order, nodes.size()));
+    node_id_mapping mapping = reordered.reorder(order);
+
+    CHECK(reordered.edge_count() == original.edge_count());
+    CHECK(reordered.max_degree() == original.max_degree());
+
+    for (std::uint32_t old_id = 0; old_id < nodes.size(); ++old_id) {
+        std::uint32_t new_id = mapping.to_new(old_id);
+        CHECK(mapping.to_old(new_id) == old_id);
+        CHECK(&reordered.node_at(new_id) == &original.node_at(old_id));
+        CHECK(reordered.id_of(*nodes[old_id]) == new_id);
+        CHECK(reordered.degree(new_id) == original.degree(old_id));
+        CHECK(std::is_sorted(reordered.heads(new_id),
+                             reordered.heads(new_id)
+                             + reordered.degree(new_id)));
+    }
+
+    std::mt19937 random(6);
+    std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+
+    for (int query = 0; query < 50; ++query) {
+        grid_cell& source = *nodes[pick(random)];
+        grid_cell& target = *nodes[pick(random)];
+        CHECK(distance(reordered, source, target)
+              == distance(original, source, target));
+    }
+}
+
+int main() {
+    grid_weight_function w;
+    grid cells = make_grid(30, 25, 0.3, 12);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    contiguous_graph<grid_cell, int> graph(nodes, w);
+
+    check_order(cells, bfs_order(graph));
+    check_order(cells, cuthill_mckee_order(graph));
+    check_order(cells, cuthill_mckee_order(graph, false));
+    check_order(cells, hilbert_order(graph));
+
+    // Anything but a permutation is rejected.
+    std::vector<std::uint32_t> repeated(nodes.size(), 0);
+    std::vector<std::uint32_t> too_short(nodes.size() - 1, 0);
+    int rejected = 0;
+
+    for (const std::vector<std::uint32_t>* order : { &repeated, &too_short }) {
+        try {
+            graph.reorder(*order);
+        } catch (std::invalid_argument&) {
+            ++rejected;
+        }
+    }
+
+    CHECK(rejected == 2);
+    return report("graph_reordering_test");
+}
@@ -0,0 +1,136 @@
+// Compares HPA* paths with the optimal paths A* finds on random grids.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/hpa_star_test.cpp -o hpa_star_test
+//   ./hpa_star_test
+
+#include "a_star.hpp"
+#include "hpa_star.hpp"
+#include "metric_heuristics.hpp"
+#include "path_not_found_exception.hpp"
+#include "tests/test_support.hpp"
+#include <random>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+// True if every step of 'path' is an edge and the weights add up.
+static bool is_valid_path(const weighted_path<grid_cell, int>& path,
+                          const grid_cell& source,
+                          const grid_cell& target,
+                          const grid_weight_function& w) {
+    if (!(path.node_at(0) == source)) {
+        return false;
+    }
+
+    int total = 0;
+
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        bool is_child = false;
+
+        for (grid_cell& child : path.node_at(i - 1)) {
+            is_child = is_child || &child == &path.node_at(i);
+        }
+
+        if (!is_child) {
+            return false;
+        }
+
+        total += w(path.node_at(i - 1), path.node_at(i));
+    }
+
+    return path.node_at(path.size() - 1) == target
+        && total == path.total_weight();
+}
+
+int main() {
+    grid_weight_function w;
+    grid cells = make_grid(60, 50, 0.25, 7);
+    hierarchical_grid<grid_cell, int> hierarchy(cells, 8, &w);
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> pick_x(0, 59);
+    std::uniform_int_distribution<int> pick_y(0, 49);
+    int found = 0;
+
+    for (int query = 0; query < 200; ++query) {
+        grid_cell& source = cells[pick_y(random)][pick_x(random)];
+        grid_cell& target = cells[pick_y(random)][pick_x(random)];
+
+        if (source.blocked() || target.blocked()) {
+            continue;
+        }
+
+        manhattan_heuristic<grid_cell, int> h(target);
+        int optimal = -1;
+
+        try {
+            optimal = search(source, target, w, h).total_weight();
+        } catch (path_not_found_exception<grid_cell>&) {
+        }
+
+        try {
+            abstract_path<grid_cell, int> path = hierarchy.find_path(source,
+                                                                     target,
+                                                                     h);
+            weighted_path<grid_cell, int> refined = path.refine();
+            CHECK(optimal >= 0);
+            CHECK(refined.total_weight() == path.total_weight());
+            CHECK(refined.total_weight() >= optimal);
+            CHECK(is_valid_path(refined, source, target, w));
+            ++found;
+        } catch (path_not_found_exception<grid_cell>&) {
+            CHECK(optimal < 0);
+        }
+    }
+
+    CHECK(found > 50);
+
+    // Blocking a cell on a path and reporting it reroutes around it; the
+    // blocked cell has no edges left, so a valid path avoids it. Columns 29
+    // to 31 are cleared first so that a detour exists.
+    for (int y = 0; y < 50; ++y) {
+        for (int x = 29; x <= 31; ++x) {
+            cells[y][x].set_blocked(false);
+        }
+    }
+
+    link_grid(cells);
+
+    for (int y = 0; y < 50; ++y) {
+        for (int x = 29; x <= 31; ++x) {
+            hierarchy.update_cell(x, y);
+        }
+    }
+
+    grid_cell& source = cells[25][29];
+    grid_cell& target = cells[25][31];
+    weighted_path<grid_cell, int> before =
+    hierarchy.find_path(source, target).refine();
+    grid_cell& middle = before.node_at(1);
+    middle.set_blocked(true);
+    link_grid(cells);
+    hierarchy.update_cell(middle.x(), middle.y());
+
+    try {
+        weighted_path<grid_cell, int> after =
+        hierarchy.find_path(source, target).refine();
+        CHECK(is_valid_path(after, source, target, w));
+        CHECK(after.total_weight() >= before.total_weight());
+    } catch (path_not_found_exception<grid_cell>&) {
+        CHECK(false);
+    }
+
+    // Nodes whose coordinates do not match their cell are rejected.
+    grid swapped = make_grid(4, 4, 0.0, 1);
+    std::swap(swapped[0][0], swapped[0][1]);
+    bool rejected = false;
+
+    try {
+        hierarchical_grid<grid_cell, int> bad(swapped, 2, &w);
+    } catch (std::invalid_argument&) {
+        rejected = true;
+    }
+
+    CHECK(rejected);
+    return report("hpa_star_test");
+}
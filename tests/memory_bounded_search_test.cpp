@@ -0,0 +1,166 @@
+// Checks the memory-bounded search against A* and makes sure it stops on
+// unreachable targets.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/memory_bounded_search_test.cpp -o memory_bounded_search_test
+//   ./memory_bounded_search_test
+
+#include "metric_heuristics.hpp"
+#include "pathfinding.hpp"
+#include "tests/test_support.hpp"
+#include <random>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+// -1 if the search proved the target unreachable, -2 if it gave up.
+static int bounded_distance(grid_cell& source,
+                            grid_cell& target,
+                            std::size_t memory_budget,
+                            std::size_t beam_width,
+                            bool& optimal) {
+    grid_weight_function w;
+    manhattan_heuristic<grid_cell, int> h(target);
+
+    try {
+        bounded_path<grid_cell, int> path = bounded_search(source,
+                                                           target,
+                                                           w,
+                                                           h,
+                                                           memory_budget,
+                                                           beam_width);
+        optimal = path.is_optimal();
+        return path.total_weight();
+    } catch (path_not_found_exception<grid_cell>&) {
+        return -1;
+    } catch (search_budget_exceeded_exception&) {
+        return -2;
+    }
+}
+
+static void check_against_a_star() {
+    grid_weight_function w;
+    grid cells = make_grid(40, 40, 0.2, 3);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> pick(0, 39);
+    int compared = 0;
+    int finished = 0;
+
+    for (int query = 0; query < 30; ++query) {
+        grid_cell& source = cells[pick(random)][pick(random)];
+        grid_cell& target = cells[pick(random)][pick(random)];
+        manhattan_heuristic<grid_cell, int> h(target);
+        int optimal;
+
+        try {
+            optimal = search(source, target, w, h).total_weight();
+        } catch (path_not_found_exception<grid_cell>&) {
+            continue;
+        }
+
+        bool is_optimal = false;
+
+        // Room for the whole grid, then for a fraction of it, where some
+        // queries regenerate too much to finish within the default limit.
+        CHECK(bounded_distance(source, target, 1 << 20, 0, is_optimal)
+              == optimal);
+        CHECK(is_optimal);
+
+        int tight = bounded_distance(source, target, 1 << 16, 0, is_optimal);
+        CHECK(tight == optimal || tight == -2);
+        CHECK(tight == -2 || is_optimal);
+        finished += tight == optimal;
+
+        int beam = bounded_distance(source, target, 1 << 16, 8, is_optimal);
+        CHECK(beam == -1 || beam == -2 || beam >= optimal);
+        ++compared;
+    }
+
+    CHECK(compared > 10);
+    CHECK(finished * 4 >= compared * 3);
+}
+
+// A target whose neighbours are all blocked, searched within 64 KiB, which
+// is far less than the grid needs: the search used to regenerate the
+// forgotten subtrees forever.
+static void check_unreachable() {
+    grid_weight_function w;
+    grid cells = make_grid(40, 40, 0.0, 1);
+    cells[20][19].set_blocked(true);
+    cells[20][21].set_blocked(true);
+    cells[19][20].set_blocked(true);
+    cells[21][20].set_blocked(true);
+    link_grid(cells);
+
+    grid_cell& source = cells[0][0];
+    grid_cell& target = cells[20][20];
+    manhattan_heuristic<grid_cell, int> h(target);
+    const std::size_t budget = 64 * 1024;
+    int stopped = 0;
+
+    try {
+        bounded_search(source, target, w, h, budget);
+    } catch (search_budget_exceeded_exception&) {
+        ++stopped;
+    } catch (path_not_found_exception<grid_cell>&) {
+        ++stopped;
+    }
+
+    try {
+        find_shortest_path<grid_cell, int>()
+        .from(source)
+        .to(target)
+        .with_weights(&w)
+        .memory_bounded(budget)
+        .without_heuristic_function();
+    } catch (search_budget_exceeded_exception&) {
+        ++stopped;
+    } catch (path_not_found_exception<grid_cell>&) {
+        ++stopped;
+    }
+
+    CHECK(stopped == 2);
+
+    // The default limit allows 16 expansions per node that fits.
+    std::size_t default_limit = 0;
+
+    try {
+        bounded_search(source, target, w, h, budget);
+    } catch (search_budget_exceeded_exception& e) {
+        default_limit = e.budget();
+    }
+
+    CHECK(default_limit > 0);
+    CHECK(default_limit <= bounded_search_expansions_per_node * budget
+                           / sizeof(bounded_search_node<grid_cell, int>));
+    CHECK(default_limit <= bounded_search_max_default_expansions);
+
+    // An explicit limit overrides the default.
+    bool limited = false;
+
+    try {
+        bounded_search(source, target, w, h, budget, 0, 100);
+    } catch (search_budget_exceeded_exception& e) {
+        limited = e.budget() == 100;
+    }
+
+    CHECK(limited);
+}
+
+int main() {
+    check_against_a_star();
+    check_unreachable();
+
+    // Not even two nodes fit.
+    grid cells = make_grid(2, 2, 0.0, 1);
+    bool thrown = false;
+
+    try {
+        bounded_search(cells[0][0], cells[1][1], grid_weight_function(), 64);
+    } catch (search_budget_exceeded_exception&) {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    return report("memory_bounded_search_test");
+}
@@ -0,0 +1,199 @@
+// Checks that the batched heuristics agree with the single estimates and
+// the scalar formulas, that they never overestimate on grids, and that the
+// searches estimate each node only once.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/metric_heuristics_test.cpp -o metric_heuristics_test
+//   ./metric_heuristics_test
+
+#include "metric_heuristics.hpp"
+#include "pathfinding.hpp"
+#include "tests/test_support.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+// A point with real coordinates; used as longitude and latitude too.
+class point {
+public:
+    point(double x, double y) : m_x{x}, m_y{y} {}
+
+    double x() const { return m_x; }
+    double y() const { return m_y; }
+
+private:
+    double m_x;
+    double m_y;
+};
+
+static std::vector<point> random_points(std::size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+    std::vector<point> points;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        points.emplace_back(longitude(random), latitude(random));
+    }
+
+    return points;
+}
+
+static bool close(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+// 'estimate_batch()' and 'estimate_span()' must return what 'operator()'
+// returns, for counts that are not multiples of the vector width or of the
+// batch size.
+static void check_batch(const heuristic_function<point, double>& h,
+                        std::vector<point>& points) {
+    std::vector<point*> nodes;
+
+    for (point& p : points) {
+        nodes.push_back(&p);
+    }
+
+    for (std::size_t count : { 0, 1, 3, 4, 5, 63, 64, 65, 150 }) {
+        std::vector<double> estimates(count);
+        std::vector<double> span_estimates(count);
+        h.estimate_batch(nodes.data(), count, estimates.data());
+        h.estimate_span(points.data(), count, span_estimates.data());
+
+        for (std::size_t i = 0; i < count; ++i) {
+            CHECK(close(estimates[i], h(*nodes[i])));
+            CHECK(span_estimates[i] == estimates[i]);
+        }
+    }
+}
+
+static void check_formulas(std::vector<point>& points) {
+    point target(12.5, -40.25);
+    manhattan_heuristic<point, double> manhattan(target, 2.0);
+    octile_heuristic<point, double> octile(target);
+    euclidean_heuristic<point, double> euclidean(target);
+    great_circle_heuristic<point, double> great_circle(target, 1.0);
+
+    check_batch(manhattan, points);
+    check_batch(octile, points);
+    check_batch(euclidean, points);
+    check_batch(great_circle, points);
+
+    const double pi = std::acos(-1.0);
+
+    for (const point& p : points) {
+        double dx = std::abs(p.x() - target.x());
+        double dy = std::abs(p.y() - target.y());
+        CHECK(close(manhattan(p), 2.0 * (dx + dy)));
+        CHECK(close(octile(p), std::max(dx, dy)
+                               + (std::sqrt(2.0) - 1) * std::min(dx, dy)));
+        CHECK(close(euclidean(p), std::sqrt(dx * dx + dy * dy)));
+
+        // Spherical law of cosines on the unit sphere.
+        double phi1 = p.y() * pi / 180;
+        double phi2 = target.y() * pi / 180;
+        double cosine = std::sin(phi1) * std::sin(phi2)
+                      + std::cos(phi1) * std::cos(phi2)
+                      * std::cos((p.x() - target.x()) * pi / 180);
+        double arc = std::acos(std::max(-1.0, std::min(1.0, cosine)));
+        CHECK(std::abs(great_circle(p) - arc) < 1e-6);
+    }
+}
+
+// Every move of 'grid_weight_function' costs at least 1, so the metrics
+// with unit scale are admissible, and A* finds the Dijkstra distance.
+static void check_admissible() {
+    grid_weight_function w;
+    grid cells = make_grid(30, 30, 0.2, 4);
+    std::mt19937 random(8);
+    std::uniform_int_distribution<int> pick(0, 29);
+
+    for (int query = 0; query < 40; ++query) {
+        grid_cell& source = cells[pick(random)][pick(random)];
+        grid_cell& target = cells[pick(random)][pick(random)];
+        manhattan_heuristic<grid_cell, int> manhattan(target);
+        octile_heuristic<grid_cell, int> octile(target);
+        euclidean_heuristic<grid_cell, int> euclidean(target);
+        int optimal;
+
+        try {
+            optimal = search(source, target, w).total_weight();
+        } catch (path_not_found_exception<grid_cell>&) {
+            continue;
+        }
+
+        CHECK(manhattan(source) <= optimal);
+        CHECK(octile(source) <= optimal);
+        CHECK(euclidean(source) <= optimal);
+        CHECK(search(source, target, w, manhattan).total_weight() == optimal);
+        CHECK(search(source, target, w, octile).total_weight() == optimal);
+        CHECK(search(source, target, w, euclidean).total_weight() == optimal);
+    }
+}
+
+// Counts the estimates of every node.
+class counting_heuristic : public virtual heuristic_function<grid_cell, int> {
+public:
+    explicit counting_heuristic(const grid_cell& target) : m_metric{target} {}
+
+    int operator()(const grid_cell& node) const {
+        ++m_counts[&node];
+        return m_metric(node);
+    }
+
+    const std::map<const grid_cell*, int>& counts() const {
+        return m_counts;
+    }
+
+private:
+    manhattan_heuristic<grid_cell, int> m_metric;
+    mutable std::map<const grid_cell*, int> m_counts;
+};
+
+// Weights 1 to 4 make A* reach many nodes again over a cheaper edge; those
+// nodes are pushed again but must not be estimated again.
+static void check_estimated_once() {
+    grid_weight_function w;
+    grid cells = make_grid(30, 30, 0.2, 6);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    contiguous_graph<grid_cell, int> graph(nodes, w);
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> pick(0, 29);
+    std::size_t estimated = 0;
+
+    for (int query = 0; query < 20; ++query) {
+        grid_cell& source = cells[pick(random)][pick(random)];
+        grid_cell& target = cells[pick(random)][pick(random)];
+        counting_heuristic node_based(target);
+        counting_heuristic contiguous(target);
+
+        try {
+            search(source, target, w, node_based);
+            search(graph, source, target, contiguous);
+        } catch (path_not_found_exception<grid_cell>&) {
+        }
+
+        for (const counting_heuristic* h : { &node_based, &contiguous }) {
+            for (const auto& entry : h->counts()) {
+                CHECK(entry.second == 1);
+            }
+
+            estimated += h->counts().size();
+        }
+    }
+
+    CHECK(estimated > 0);
+}
+
+int main() {
+    std::vector<point> points = random_points(150, 2);
+    check_formulas(points);
+    check_admissible();
+    check_estimated_once();
+    return report("metric_heuristics_test");
+}
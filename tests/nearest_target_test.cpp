@@ -0,0 +1,93 @@
+// Checks nearest-of-many-targets queries against one search per target.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/nearest_target_test.cpp -o nearest_target_test
+//   ./nearest_target_test
+
+#include "metric_heuristics.hpp"
+#include "pathfinding.hpp"
+#include "tests/test_support.hpp"
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+int main() {
+    grid_weight_function w;
+    grid cells = make_grid(40, 40, 0.3, 5);
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> pick(0, 39);
+
+    for (int query = 0; query < 60; ++query) {
+        grid_cell& source = cells[pick(random)][pick(random)];
+        std::vector<grid_cell*> targets;
+        std::vector<std::unique_ptr<manhattan_heuristic<grid_cell, int>>> owned;
+        std::vector<heuristic_function<grid_cell, int>*> heuristics;
+
+        while (targets.size() < static_cast<std::size_t>(1 + query % 6)) {
+            grid_cell& target = cells[pick(random)][pick(random)];
+            targets.push_back(&target);
+            owned.emplace_back(new manhattan_heuristic<grid_cell, int>(target));
+            heuristics.push_back(owned.back().get());
+        }
+
+        int nearest = -1;
+
+        for (grid_cell* target : targets) {
+            try {
+                int distance = search(source, *target, w).total_weight();
+
+                if (nearest < 0 || distance < nearest) {
+                    nearest = distance;
+                }
+            } catch (path_not_found_exception<grid_cell>&) {
+            }
+        }
+
+        min_heuristic_function<grid_cell, int> h(heuristics);
+
+        try {
+            nearest_target_path<grid_cell, int> path =
+            find_shortest_path<grid_cell, int>()
+            .from(source)
+            .to_any_of(targets)
+            .with_weights(&w)
+            .without_heuristic_function();
+
+            nearest_target_path<grid_cell, int> guided =
+            find_shortest_path<grid_cell, int>()
+            .from(source)
+            .to_any_of(targets)
+            .with_weights(&w)
+            .with_heuristic_function(&h);
+
+            CHECK(path.total_weight() == nearest);
+            CHECK(guided.total_weight() == nearest);
+            CHECK(search(source, path.target(), w).total_weight() == nearest);
+        } catch (path_not_found_exception<grid_cell>&) {
+            CHECK(nearest < 0);
+        }
+    }
+
+    // A source among the targets is its own nearest target.
+    grid open_cells = make_grid(5, 5, 0.0, 1);
+    std::vector<grid_cell*> targets{&open_cells[4][4], &open_cells[2][2]};
+    nearest_target_path<grid_cell, int> trivial =
+    search(open_cells[2][2], targets, w);
+    CHECK(trivial.total_weight() == 0);
+    CHECK(&trivial.target() == &open_cells[2][2]);
+
+    // No targets at all.
+    bool thrown = false;
+
+    try {
+        search(open_cells[0][0], std::vector<grid_cell*>(), w);
+    } catch (path_not_found_exception<grid_cell>&) {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    return report("nearest_target_test");
+}
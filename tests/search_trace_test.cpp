@@ -0,0 +1,166 @@
+// Checks that trace files hold the records of every sampled query and
+// account for the records dropped by full rings.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/search_trace_test.cpp -o search_trace_test
+//   ./search_trace_test
+
+#include "a_star.hpp"
+#include "metric_heuristics.hpp"
+#include "search_trace.hpp"
+#include "tests/test_support.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    template<>
+    struct trace_key<grid_cell> {
+        std::uint64_t operator()(const grid_cell& cell) const {
+            return grid_trace_key(cell.x(), cell.y());
+        }
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+static const char* const trace_file = "search_trace_test.trace";
+
+static std::vector<trace_record> read_records() {
+    std::ifstream in(trace_file, std::ios::binary);
+    char magic[sizeof(trace_file_magic)];
+    std::uint32_t record_size = 0;
+    std::vector<trace_record> records;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+    CHECK(static_cast<bool>(in));
+    CHECK(std::memcmp(magic, trace_file_magic, sizeof(magic)) == 0);
+    CHECK(record_size == sizeof(trace_record));
+
+    trace_record record;
+
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+// Runs three traced searches and returns the number of records the
+// recorder reports as dropped.
+static std::uint64_t trace_searches(std::size_t ring_capacity) {
+    grid_weight_function w;
+    grid cells = make_grid(20, 20, 0.0, 3);
+    trace_recorder tracer(trace_file, 1, ring_capacity, 0);
+
+    for (int i = 0; i < 3; ++i) {
+        grid_cell& target = cells[19 - i][19];
+        manhattan_heuristic<grid_cell, int> h(target);
+
+        search(cells[i][0], target, w, h, &tracer);
+    }
+
+    tracer.flush();
+    return tracer.dropped_records();
+}
+
+// The sources of the traced queries, sorted; the rings of different
+// threads are written in no particular order.
+static std::vector<std::uint64_t> traced_sources() {
+    std::vector<std::uint64_t> sources;
+
+    for (const trace_record& record : read_records()) {
+        if (record.event() == trace_event::query_begin) {
+            sources.push_back(record.m_key);
+        }
+    }
+
+    std::sort(sources.begin(), sources.end());
+    return sources;
+}
+
+// With 'sample_every' = 3 a thread traces its queries 0, 3, 6 and 9 out of
+// ten; another thread counts its own queries from 0.
+static void check_sampling() {
+    grid_weight_function w;
+    grid cells = make_grid(20, 20, 0.0, 3);
+    grid_cell& target = cells[19][19];
+    manhattan_heuristic<grid_cell, int> h(target);
+
+    {
+        trace_recorder tracer(trace_file, 3, 1 << 16, 0);
+
+        for (int i = 0; i < 10; ++i) {
+            search(cells[i][0], target, w, h, &tracer);
+        }
+
+        std::thread other([&]() {
+            search(cells[0][5], target, w, h, &tracer);
+            search(cells[0][6], target, w, h, &tracer);
+        });
+
+        other.join();
+    }
+
+    std::vector<std::uint64_t> expected = {
+        grid_trace_key(0, 0),
+        grid_trace_key(0, 3),
+        grid_trace_key(0, 6),
+        grid_trace_key(0, 9),
+        grid_trace_key(5, 0),
+    };
+
+    std::sort(expected.begin(), expected.end());
+    CHECK(traced_sources() == expected);
+}
+
+int main() {
+    // Roomy rings: every query begins and ends, nothing is dropped.
+    CHECK(trace_searches(1 << 16) == 0);
+    std::vector<trace_record> records = read_records();
+    int begins = 0;
+    int ends = 0;
+
+    for (const trace_record& record : records) {
+        CHECK(record.m_query != dropped_records_query);
+        begins += record.event() == trace_event::query_begin;
+        ends += record.event() == trace_event::query_end;
+    }
+
+    CHECK(begins == 3);
+    CHECK(ends == 3);
+
+    // Tiny rings overflow; the file states how many records were lost.
+    std::uint64_t dropped = trace_searches(4);
+    CHECK(dropped > 0);
+    records = read_records();
+    std::uint64_t reported = 0;
+    std::size_t kept = 0;
+
+    for (const trace_record& record : records) {
+        if (record.m_query == dropped_records_query) {
+            reported += record.m_key;
+        } else {
+            ++kept;
+        }
+    }
+
+    CHECK(reported == dropped);
+    CHECK(kept == 4);
+
+    check_sampling();
+
+    std::remove(trace_file);
+    return report("search_trace_test");
+}
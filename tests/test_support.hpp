@@ -0,0 +1,204 @@
+#ifndef NET_CODERODDE_PATHFINDING_TEST_SUPPORT_HPP
+#define NET_CODERODDE_PATHFINDING_TEST_SUPPORT_HPP
+
+// Shared helpers of the tests in this directory. Every test is a single
+// program that is built and run from the repository root, for example:
+//
+//   g++ -std=c++14 -O2 -pthread -I. tests/hpa_star_test.cpp -o hpa_star_test
+//   ./hpa_star_test
+//
+// It prints the failed checks and exits with a nonzero status if any.
+
+#include "weight_function.hpp"
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+namespace test {
+
+    inline int& failure_count() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void check(bool condition,
+                      const char* expression,
+                      const char* file,
+                      int line) {
+        if (!condition) {
+            ++failure_count();
+            std::cerr << file << ":" << line << ": check failed: "
+                      << expression << "\n";
+        }
+    }
+
+    inline int report(const char* test_name) {
+        if (failure_count() == 0) {
+            std::cout << test_name << ": passed\n";
+            return 0;
+        }
+
+        std::cout << test_name << ": " << failure_count() << " failed\n";
+        return 1;
+    }
+
+    // A cell of a 4-connected grid built by 'make_grid()'.
+    class grid_cell {
+    public:
+        class child_iterator {
+        public:
+            child_iterator(grid_cell* const* it) : m_it{it} {}
+
+            child_iterator& operator++() {
+                ++m_it;
+                return *this;
+            }
+
+            bool operator!=(const child_iterator& other) const {
+                return m_it != other.m_it;
+            }
+
+            grid_cell& operator*() const {
+                return **m_it;
+            }
+
+        private:
+            grid_cell* const* m_it;
+        };
+
+        grid_cell(int x, int y, bool blocked)
+        :
+        m_x{x},
+        m_y{y},
+        m_blocked{blocked}
+        {}
+
+        int x() const { return m_x; }
+        int y() const { return m_y; }
+        bool blocked() const { return m_blocked; }
+
+        void set_blocked(bool blocked) { m_blocked = blocked; }
+
+        void add_child(grid_cell& child) {
+            m_children.push_back(&child);
+        }
+
+        void clear_children() {
+            m_children.clear();
+        }
+
+        child_iterator begin() const {
+            return child_iterator(m_children.data());
+        }
+
+        child_iterator end() const {
+            return child_iterator(m_children.data() + m_children.size());
+        }
+
+        bool operator==(const grid_cell& other) const {
+            return m_x == other.m_x && m_y == other.m_y;
+        }
+
+    private:
+        int                     m_x;
+        int                     m_y;
+        bool                    m_blocked;
+        std::vector<grid_cell*> m_children;
+
+        friend std::ostream& operator<<(std::ostream& out,
+                                        const grid_cell& cell) {
+            return out << "{x=" << cell.m_x << ", y=" << cell.m_y << "}";
+        }
+    };
+
+    typedef std::vector<std::vector<grid_cell>> grid;
+
+    // Links every passable cell to its passable 4-neighbours.
+    inline void link_grid(grid& cells) {
+        const int dx[] = { 0, 0, -1, 1 };
+        const int dy[] = { -1, 1, 0, 0 };
+        int height = static_cast<int>(cells.size());
+
+        for (int y = 0; y < height; ++y) {
+            int width = static_cast<int>(cells[y].size());
+
+            for (int x = 0; x < width; ++x) {
+                grid_cell& cell = cells[y][x];
+                cell.clear_children();
+
+                if (cell.blocked()) {
+                    continue;
+                }
+
+                for (int d = 0; d < 4; ++d) {
+                    int nx = x + dx[d];
+                    int ny = y + dy[d];
+
+                    if (nx >= 0 && ny >= 0 && nx < width && ny < height
+                        && !cells[ny][nx].blocked()) {
+                        cell.add_child(cells[ny][nx]);
+                    }
+                }
+            }
+        }
+    }
+
+    // A 'width' x 'height' grid, addressed as cells[y][x], in which each
+    // cell is blocked with probability 'blocked_ratio'.
+    inline grid make_grid(int width,
+                          int height,
+                          double blocked_ratio,
+                          unsigned seed) {
+        std::mt19937 random(seed);
+        std::bernoulli_distribution block(blocked_ratio);
+        grid cells(height);
+
+        for (int y = 0; y < height; ++y) {
+            cells[y].reserve(width);
+
+            for (int x = 0; x < width; ++x) {
+                cells[y].emplace_back(x, y, block(random));
+            }
+        }
+
+        link_grid(cells);
+        return cells;
+    }
+
+    inline std::vector<grid_cell*> cell_pointers(grid& cells) {
+        std::vector<grid_cell*> pointers;
+
+        for (auto& row : cells) {
+            for (grid_cell& cell : row) {
+                pointers.push_back(&cell);
+            }
+        }
+
+        return pointers;
+    }
+
+    // Moves cost 1 to 4 depending on the cells.
+    class grid_weight_function :
+    public virtual weight_function<grid_cell, int> {
+    public:
+        int operator()(const grid_cell& tail, const grid_cell& head) const {
+            return 1 + (tail.x() * 7 + head.y() * 3) % 4;
+        }
+    };
+
+} // End of namespace net::coderodde::pathfinding::test.
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#define CHECK(condition) \
+    net::coderodde::pathfinding::test::check((condition), \
+                                             #condition, \
+                                             __FILE__, \
+                                             __LINE__)
+
+#endif // NET_CODERODDE_PATHFINDING_TEST_SUPPORT_HPP
@@ -0,0 +1,159 @@
+// Runs many searches on one shared graph from several threads at once and
+// compares every result with a single-threaded run. Build it with
+// ThreadSanitizer to check for data races as well:
+//
+//   g++ -std=c++14 -O1 -g -pthread -fsanitize=thread -I. tests/thread_safety_test.cpp -o thread_safety_test
+//   ./thread_safety_test
+//
+// Without -fsanitize=thread it only checks the results.
+
+#include "contiguous_search.hpp"
+#include "hpa_star.hpp"
+#include "metric_heuristics.hpp"
+#include "pathfinding.hpp"
+#include "tests/test_support.hpp"
+#include <atomic>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+const int thread_count = 8;
+const int width = 48;
+const int height = 40;
+
+struct query {
+    grid_cell* m_source;
+    grid_cell* m_target;
+};
+
+// The distances found by each kind of search, -1 if there is no path.
+struct answers {
+    int m_a_star;
+    int m_dijkstra;
+    int m_contiguous;
+    int m_bounded;
+    int m_hierarchical;
+    int m_nearest;
+};
+
+template<typename Search>
+static int distance_or_none(Search search) {
+    try {
+        return search();
+    } catch (path_not_found_exception<grid_cell>&) {
+        return -1;
+    }
+}
+
+static answers answer(const query& q,
+                      const contiguous_graph<grid_cell, int>& graph,
+                      const hierarchical_grid<grid_cell, int>& hierarchy,
+                      const grid_weight_function& w) {
+    grid_cell& source = *q.m_source;
+    grid_cell& target = *q.m_target;
+    manhattan_heuristic<grid_cell, int> h(target);
+    answers a;
+
+    a.m_a_star = distance_or_none([&]() {
+        return find_shortest_path<grid_cell, int>()
+               .from(source)
+               .to(target)
+               .with_weights(&w)
+               .with_heuristic_function(&h)
+               .total_weight();
+    });
+
+    a.m_dijkstra = distance_or_none([&]() {
+        return search(source, target, w).total_weight();
+    });
+
+    a.m_contiguous = distance_or_none([&]() {
+        return search(graph, source, target, h).total_weight();
+    });
+
+    a.m_bounded = distance_or_none([&]() {
+        return bounded_search(source, target, w, h, 1 << 20).total_weight();
+    });
+
+    a.m_hierarchical = distance_or_none([&]() {
+        return hierarchy.find_path(source, target, h).total_weight();
+    });
+
+    std::vector<grid_cell*> targets{&target, q.m_source};
+    a.m_nearest = distance_or_none([&]() {
+        return search(source, targets, w).total_weight();
+    });
+
+    return a;
+}
+
+static bool operator==(const answers& a, const answers& b) {
+    return a.m_a_star == b.m_a_star
+        && a.m_dijkstra == b.m_dijkstra
+        && a.m_contiguous == b.m_contiguous
+        && a.m_bounded == b.m_bounded
+        && a.m_hierarchical == b.m_hierarchical
+        && a.m_nearest == b.m_nearest;
+}
+
+int main() {
+    const grid_weight_function w;
+    grid cells = make_grid(width, height, 0.25, 13);
+    std::vector<grid_cell*> nodes = cell_pointers(cells);
+    const contiguous_graph<grid_cell, int> graph(nodes, w);
+    const hierarchical_grid<grid_cell, int> hierarchy(cells, 8, &w);
+
+    std::mt19937 random(2);
+    std::uniform_int_distribution<int> pick_x(0, width - 1);
+    std::uniform_int_distribution<int> pick_y(0, height - 1);
+    std::vector<query> queries;
+
+    while (queries.size() < 96) {
+        grid_cell& source = cells[pick_y(random)][pick_x(random)];
+        grid_cell& target = cells[pick_y(random)][pick_x(random)];
+
+        if (!source.blocked() && !target.blocked()) {
+            queries.push_back(query{&source, &target});
+        }
+    }
+
+    std::vector<answers> expected;
+
+    for (const query& q : queries) {
+        expected.push_back(answer(q, graph, hierarchy, w));
+        CHECK(expected.back().m_a_star == expected.back().m_dijkstra);
+        CHECK(expected.back().m_a_star == expected.back().m_contiguous);
+        CHECK(expected.back().m_a_star == expected.back().m_bounded);
+        CHECK(expected.back().m_nearest == 0);
+    }
+
+    // Each thread answers every query, starting at a different one, so
+    // that different searches overlap in time.
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (std::size_t i = 0; i < queries.size(); ++i) {
+                std::size_t index = (i + t * queries.size() / thread_count)
+                                  % queries.size();
+
+                if (!(answer(queries[index], graph, hierarchy, w)
+                      == expected[index])) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(mismatches == 0);
+    return report("thread_safety_test");
+}
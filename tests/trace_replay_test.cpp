@@ -0,0 +1,155 @@
+// Checks the per-query summaries and the heatmap that trace_replay prints
+// and draws, on hand-made records and on a recorded search.
+//
+// Build and run from the repository root:
+//   g++ -std=c++14 -O2 -pthread -I. tests/trace_replay_test.cpp -o trace_replay_test
+//   ./trace_replay_test
+
+#include "a_star.hpp"
+#include "metric_heuristics.hpp"
+#include "trace_replay.hpp"
+#include "tests/test_support.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace net::coderodde::pathfinding;
+using namespace net::coderodde::pathfinding::test;
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    template<>
+    struct trace_key<grid_cell> {
+        std::uint64_t operator()(const grid_cell& cell) const {
+            return grid_trace_key(cell.x(), cell.y());
+        }
+    };
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+static const char* const trace_file = "trace_replay_test.trace";
+
+static trace_record make_record(std::uint32_t query,
+                                trace_event event,
+                                std::uint64_t key,
+                                std::uint32_t value) {
+    trace_record record;
+    record.m_key = key;
+    record.m_query = query;
+    record.m_event_and_value =
+    (static_cast<std::uint32_t>(event) << trace_record::value_bits) | value;
+    return record;
+}
+
+// Two interleaved queries and a notice of 5 dropped records.
+static void check_summaries() {
+    const std::uint64_t a = grid_trace_key(0, 0);
+    const std::uint64_t b = grid_trace_key(1, 0);
+    const std::uint64_t c = grid_trace_key(2, 1);
+    std::vector<trace_record> records = {
+        make_record(1, trace_event::query_begin, a, 0),
+        make_record(2, trace_event::query_begin, c, 0),
+        make_record(1, trace_event::expansion, a, 1),
+        make_record(1, trace_event::relaxation, b, 0),
+        make_record(2, trace_event::expansion, c, 7),
+        make_record(1, trace_event::relaxation, c, 0),
+        make_record(1, trace_event::expansion, b, 4),
+        make_record(1, trace_event::expansion, b, 2),
+        make_record(dropped_records_query, trace_event::query_begin, 5, 0),
+        make_record(1, trace_event::query_end, c, 1),
+    };
+
+    trace_summary trace = summarize_trace(records);
+    CHECK(trace.m_queries.size() == 2);
+    CHECK(trace.m_dropped == 5);
+
+    const query_summary& first = trace.m_queries[1];
+    CHECK(first.m_source == a);
+    CHECK(first.m_ended && first.m_found && first.m_goal == c);
+    CHECK(first.m_expansions == 3);
+    CHECK(first.m_reexpansions == 1);
+    CHECK(first.m_relaxations == 2);
+    CHECK(first.m_max_open_size == 4);
+
+    const query_summary& second = trace.m_queries[2];
+    CHECK(second.m_source == c);
+    CHECK(!second.m_ended);
+    CHECK(second.m_expansions == 1 && second.m_max_open_size == 7);
+
+    CHECK(trace.m_expansion_counts.at(a) == 1);
+    CHECK(trace.m_expansion_counts.at(b) == 2);
+    CHECK(trace.m_expansion_counts.at(c) == 1);
+
+    // One query only; dropped records still count.
+    trace_summary single = summarize_trace(records, true, 2);
+    CHECK(single.m_queries.size() == 1);
+    CHECK(single.m_queries.count(2) == 1);
+    CHECK(single.m_expansion_counts.size() == 1);
+    CHECK(single.m_dropped == 5);
+
+    // The 3 x 2 heatmap: b is the hottest cell, a and c are log-scaled,
+    // the rest are black.
+    std::size_t width;
+    std::size_t height;
+    std::vector<unsigned char> pixels =
+    heatmap_pixels(trace.m_expansion_counts, width, height);
+    const long scaled = std::lround(255.0 * std::log(2.0) / std::log(3.0));
+
+    CHECK(width == 3 && height == 2);
+    CHECK(pixels.size() == 6);
+    CHECK(pixels[0] == scaled);
+    CHECK(pixels[1] == 255);
+    CHECK(pixels[2] == 0);
+    CHECK(pixels[3] == 0 && pixels[4] == 0);
+    CHECK(pixels[5] == scaled);
+}
+
+// A recorded search reads back as one complete query from the source to
+// the target.
+static void check_recorded_search() {
+    grid_weight_function w;
+    grid cells = make_grid(10, 10, 0.0, 2);
+    grid_cell& source = cells[1][2];
+    grid_cell& target = cells[8][9];
+    manhattan_heuristic<grid_cell, int> h(target);
+
+    {
+        trace_recorder tracer(trace_file, 1, 1 << 16, 0);
+        search(source, target, w, h, &tracer);
+    }
+
+    std::vector<trace_record> records;
+    CHECK(read_trace(trace_file, records));
+    trace_summary trace = summarize_trace(records);
+
+    CHECK(trace.m_queries.size() == 1);
+    CHECK(trace.m_dropped == 0);
+
+    const query_summary& summary = trace.m_queries.begin()->second;
+    CHECK(summary.m_source == grid_trace_key(2, 1));
+    CHECK(summary.m_found && summary.m_goal == grid_trace_key(9, 8));
+    CHECK(summary.m_expansions > 0);
+    CHECK(summary.m_reexpansions == 0);
+    CHECK(summary.m_relaxations >= summary.m_expansions - 1);
+
+    // Anything else is not a trace file.
+    {
+        std::ofstream out(trace_file, std::ios::binary | std::ios::trunc);
+        out << "not a trace";
+    }
+
+    records.clear();
+    CHECK(!read_trace(trace_file, records));
+    std::remove(trace_file);
+}
+
+int main() {
+    check_summaries();
+    check_recorded_search();
+    return report("trace_replay_test");
+}
@@ -0,0 +1,173 @@
+// Offline viewer for trace files written by 'trace_recorder'.
+//
+// Usage: trace_replay <trace file> [--grid] [--query <id>]
+//                     [--heatmap <output.pgm>] [--top <n>]
+//
+// Prints one summary line per query: source, goal, expansions,
+// re-expansions (a sign of an inconsistent heuristic), relaxations and the
+// peak open list size. With --grid the node keys are read as
+// 'grid_trace_key(x, y)' values; then --heatmap writes a greyscale PGM image
+// of the expansion counts per cell (log scaled) and --top lists the most
+// expanded cells. --query restricts everything to one query. If the
+// recorder dropped records because its rings were full, the number is
+// reported and the counts above are lower bounds.
+
+#include "trace_replay.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using net::coderodde::pathfinding::heatmap_pixels;
+using net::coderodde::pathfinding::query_summary;
+using net::coderodde::pathfinding::read_trace;
+using net::coderodde::pathfinding::summarize_trace;
+using net::coderodde::pathfinding::trace_record;
+using net::coderodde::pathfinding::trace_summary;
+
+static std::string key_to_string(std::uint64_t key, bool grid) {
+    if (!grid) {
+        return std::to_string(key);
+    }
+
+    return "(" + std::to_string(key >> 32) + ", "
+               + std::to_string(key & 0xffffffffu) + ")";
+}
+
+static bool write_heatmap(
+            const char* file_name,
+            const std::unordered_map<std::uint64_t, std::size_t>& counts) {
+    if (counts.empty()) {
+        std::cerr << "No expansions to draw.\n";
+        return false;
+    }
+
+    std::size_t width;
+    std::size_t height;
+    std::vector<unsigned char> pixels = heatmap_pixels(counts, width, height);
+
+    std::ofstream out(file_name, std::ios::binary);
+
+    if (!out) {
+        std::cerr << "Cannot open " << file_name << "\n";
+        return false;
+    }
+
+    out << "P5\n" << width << " " << height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(pixels.data()),
+              static_cast<std::streamsize>(pixels.size()));
+    return static_cast<bool>(out);
+}
+
+int main(int argc, const char * argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace file> [--grid] "
+                  << "[--query <id>] [--heatmap <output.pgm>] [--top <n>]\n";
+        return EXIT_FAILURE;
+    }
+
+    bool grid = false;
+    bool single_query = false;
+    std::uint32_t selected_query = 0;
+    const char* heatmap_file = nullptr;
+    std::size_t top = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+
+        if (option == "--grid") {
+            grid = true;
+        } else if (option == "--query" && i + 1 < argc) {
+            single_query = true;
+            selected_query = static_cast<std::uint32_t>(
+                                        std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--heatmap" && i + 1 < argc) {
+            heatmap_file = argv[++i];
+        } else if (option == "--top" && i + 1 < argc) {
+            top = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Unknown option: " << option << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((heatmap_file || top > 0) && !grid) {
+        std::cerr << "--heatmap and --top need --grid.\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<trace_record> records;
+
+    if (!read_trace(argv[1], records)) {
+        return EXIT_FAILURE;
+    }
+
+    trace_summary trace = summarize_trace(records,
+                                          single_query,
+                                          selected_query);
+
+    std::size_t total_expansions = 0;
+
+    for (auto& entry : trace.m_queries) {
+        query_summary& summary = entry.second;
+        total_expansions += summary.m_expansions;
+
+        std::cout << "query " << entry.first
+                  << ": source " << key_to_string(summary.m_source, grid);
+
+        if (!summary.m_ended) {
+            std::cout << ", incomplete";
+        } else if (summary.m_found) {
+            std::cout << ", goal " << key_to_string(summary.m_goal, grid);
+        } else {
+            std::cout << ", no path";
+        }
+
+        std::cout << ", expansions " << summary.m_expansions
+                  << ", re-expansions " << summary.m_reexpansions
+                  << ", relaxations " << summary.m_relaxations
+                  << ", peak open " << summary.m_max_open_size << "\n";
+    }
+
+    std::cout << trace.m_queries.size() << " queries, " << records.size()
+              << " records, " << total_expansions << " expansions\n";
+
+    if (trace.m_dropped > 0) {
+        std::cout << trace.m_dropped << " records dropped by full trace rings; "
+                  << "the counts above are incomplete\n";
+    }
+
+    if (top > 0) {
+        std::vector<std::pair<std::size_t, std::uint64_t>> hotspots;
+
+        for (const auto& entry : trace.m_expansion_counts) {
+            hotspots.emplace_back(entry.second, entry.first);
+        }
+
+        std::size_t count = std::min(top, hotspots.size());
+        std::partial_sort(hotspots.begin(),
+                          hotspots.begin() + count,
+                          hotspots.end(),
+                          [](const std::pair<std::size_t, std::uint64_t>& a,
+                             const std::pair<std::size_t, std::uint64_t>& b) {
+                              return a.first > b.first;
+                          });
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::cout << key_to_string(hotspots[i].second, true) << ": "
+                      << hotspots[i].first << " expansions\n";
+        }
+    }
+
+    if (heatmap_file && !write_heatmap(heatmap_file, trace.m_expansion_counts)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
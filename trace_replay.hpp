@@ -0,0 +1,165 @@
+#ifndef NET_CODERODDE_PATHFINDING_TRACE_REPLAY_HPP
+#define NET_CODERODDE_PATHFINDING_TRACE_REPLAY_HPP
+
+#include "search_trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace net {
+namespace coderodde {
+namespace pathfinding {
+
+    struct query_summary {
+        std::uint64_t m_source         = 0;
+        std::uint64_t m_goal           = 0;
+        bool          m_ended          = false;
+        bool          m_found          = false;
+        std::size_t   m_expansions     = 0;
+        std::size_t   m_reexpansions   = 0;
+        std::size_t   m_relaxations    = 0;
+        std::uint32_t m_max_open_size  = 0;
+        std::unordered_set<std::uint64_t> m_expanded;
+    };
+
+    // What 'trace_replay' reports about a trace: a summary per query, the
+    // number of expansions per node key and the number of records the
+    // recorder dropped.
+    struct trace_summary {
+        std::map<std::uint32_t, query_summary>         m_queries;
+        std::unordered_map<std::uint64_t, std::size_t> m_expansion_counts;
+        std::uint64_t                                  m_dropped = 0;
+    };
+
+    // Reads the records of a trace file. Returns false and explains why on
+    // 'std::cerr' if the file cannot be read or is not a trace file.
+    inline bool read_trace(const char* file_name,
+                           std::vector<trace_record>& records) {
+        std::ifstream in(file_name, std::ios::binary);
+
+        if (!in) {
+            std::cerr << "Cannot open " << file_name << "\n";
+            return false;
+        }
+
+        char magic[sizeof(trace_file_magic)];
+        std::uint32_t record_size = 0;
+
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+
+        if (!in
+            || std::memcmp(magic, trace_file_magic, sizeof(magic)) != 0
+            || record_size != sizeof(trace_record)) {
+            std::cerr << file_name << " is not a trace file.\n";
+            return false;
+        }
+
+        trace_record record;
+
+        while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            records.push_back(record);
+        }
+
+        return true;
+    }
+
+    // Summarizes 'records'; if 'single_query' is set, only the records of
+    // 'selected_query' are counted. Dropped records are always counted.
+    inline trace_summary summarize_trace(
+                                const std::vector<trace_record>& records,
+                                bool single_query = false,
+                                std::uint32_t selected_query = 0) {
+        trace_summary result;
+
+        for (const trace_record& record : records) {
+            if (record.m_query == dropped_records_query) {
+                result.m_dropped += record.m_key;
+                continue;
+            }
+
+            if (single_query && record.m_query != selected_query) {
+                continue;
+            }
+
+            query_summary& summary = result.m_queries[record.m_query];
+
+            switch (record.event()) {
+                case trace_event::query_begin:
+                    summary.m_source = record.m_key;
+                    break;
+
+                case trace_event::expansion:
+                    ++summary.m_expansions;
+                    summary.m_max_open_size = std::max(summary.m_max_open_size,
+                                                       record.value());
+
+                    if (!summary.m_expanded.insert(record.m_key).second) {
+                        ++summary.m_reexpansions;
+                    }
+
+                    ++result.m_expansion_counts[record.m_key];
+                    break;
+
+                case trace_event::relaxation:
+                    ++summary.m_relaxations;
+                    break;
+
+                case trace_event::query_end:
+                    summary.m_ended = true;
+                    summary.m_found = record.value() != 0;
+                    summary.m_goal = record.m_key;
+                    break;
+            }
+        }
+
+        return result;
+    }
+
+    // The greyscale heatmap of expansion counts keyed by 'grid_trace_key()',
+    // row by row. The image spans the largest x and y among the keys; the
+    // most expanded cell is 255, unexpanded cells are 0 and the rest are
+    // scaled by log(1 + count).
+    inline std::vector<unsigned char> heatmap_pixels(
+                const std::unordered_map<std::uint64_t, std::size_t>& counts,
+                std::size_t& width,
+                std::size_t& height) {
+        std::uint32_t max_x = 0;
+        std::uint32_t max_y = 0;
+        std::size_t max_count = 0;
+
+        for (const auto& entry : counts) {
+            max_x = std::max(max_x,
+                             static_cast<std::uint32_t>(entry.first >> 32));
+            max_y = std::max(max_y, static_cast<std::uint32_t>(entry.first));
+            max_count = std::max(max_count, entry.second);
+        }
+
+        width = counts.empty() ? 0 : static_cast<std::size_t>(max_x) + 1;
+        height = counts.empty() ? 0 : static_cast<std::size_t>(max_y) + 1;
+        std::vector<unsigned char> pixels(width * height, 0);
+        double scale = 255.0 / std::log1p(static_cast<double>(max_count));
+
+        for (const auto& entry : counts) {
+            std::size_t x = static_cast<std::size_t>(entry.first >> 32);
+            std::size_t y = static_cast<std::size_t>(entry.first & 0xffffffffu);
+            pixels[y * width + x] = static_cast<unsigned char>(
+                    std::lround(std::log1p(static_cast<double>(entry.second))
+                                * scale));
+        }
+
+        return pixels;
+    }
+
+} // End of namespace net::coderodde::pathfinding.
+} // End of namespace net::coderodde.
+} // End of namespace net.
+
+#endif // NET_CODERODDE_PATHFINDING_TRACE_REPLAY_HPP
@@ -9,7 +9,9 @@ namespace pathfinding {
     class weight_function {
         
     public:
-        virtual WeightType operator()(const Node& a, const Node& b) = 0;
+        // Must not modify shared state: searches on several threads may
+        // call it concurrently.
+        virtual WeightType operator()(const Node& a, const Node& b) const = 0;
     };
     
 } // End of namespace net::coderodde::pathfinding.
@@ -2,6 +2,7 @@
 #define NET_CODERODDE_PATHFINDING_WEIGHTED_PATH_HPP
 
 #include <iostream>
+#include <vector>
 
 namespace net {
 namespace coderodde {
@@ -16,8 +17,12 @@ namespace pathfinding {
         m_total_weight{total_weight}
         {}
         
-        Node& node_at(size_t index) {
-            return *m_path_vector->at(index);
+        size_t size() const {
+            return m_path_vector.size();
+        }
+        
+        Node& node_at(size_t index) const {
+            return *m_path_vector.at(index);
         }
         
         Weight total_weight() const {
@@ -28,7 +33,8 @@ namespace pathfinding {
         std::vector<Node*> m_path_vector;
         Weight             m_total_weight;
         
-        friend std::ostream& operator<<(std::ostream& out, weighted_path& path) {
+        friend std::ostream& operator<<(std::ostream& out,
+                                        const weighted_path& path) {
             std::string separator{};
             out << "[";
             